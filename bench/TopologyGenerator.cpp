@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "TopologyGenerator.hpp"
+#include "table.hpp"
+
+extern "C" {
+#include "entries.h"
+}
+
+// the countries POPs are based in, each with its acronym.
+static const char* const COUNTRY_ACRONYMS[] = { "BR", "AR", "CL", "US", "DE" };
+static const char* const COUNTRY_NAMES[]
+    = { "Brasil", "Argentina", "Chile", "Estados Unidos", "Alemanha" };
+#define NUM_COUNTRIES 5
+
+// the largest speed of a connection, in megabits per second.
+#define MAX_LINK_SPEED 1000
+
+static const char* const TOPOLOGY_MODEL_NAMES[NUM_TOPOLOGY_MODELS]
+    = { "ring", "mesh", "barabasi-albert", "grid" };
+
+const char* topologyModelName(TopologyModel model) {
+    return TOPOLOGY_MODEL_NAMES[model];
+}
+
+bool parseTopologyModel(const char* name, TopologyModel& model) {
+    for (int index = 0; index < NUM_TOPOLOGY_MODELS; index++) {
+        if (std::strcmp(name, TOPOLOGY_MODEL_NAMES[index]) == 0) {
+            model = (TopologyModel)index;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * linksPerPop returns how many connections each POP starts in models where
+ * every connection is started by one of its ends, at least 1.
+ */
+static uint32_t linksPerPop(const TopologyParameters& parameters) {
+    return std::max<long>(1, std::lround(parameters.average_degree / 2));
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> generateLinks(
+    const TopologyParameters& parameters, std::mt19937_64& random) {
+
+    std::vector<std::pair<uint32_t, uint32_t>> links;
+    uint32_t num_pops = parameters.num_pops;
+    if (num_pops < 2) {
+        return links;
+    }
+
+    std::uniform_int_distribution<uint32_t> any_pop(0, num_pops - 1);
+
+    switch (parameters.model) {
+    case topology_ring: {
+        // a POP is never connected twice to the same one around the ring
+        uint32_t max_neighbours = std::max(1u, (num_pops - 1) / 2);
+        uint32_t neighbours
+            = std::min(linksPerPop(parameters), max_neighbours);
+        for (uint32_t pop = 0; pop < num_pops; pop++) {
+            for (uint32_t step = 1; step <= neighbours; step++) {
+                links.emplace_back(pop, (pop + step) % num_pops);
+            }
+        }
+        break;
+    }
+
+    case topology_mesh: {
+        size_t num_links
+            = std::llround(num_pops * parameters.average_degree / 2);
+        while (links.size() < num_links) {
+            uint32_t pop_a = any_pop(random);
+            uint32_t pop_b = any_pop(random);
+            if (pop_a != pop_b) {
+                links.emplace_back(pop_a, pop_b);
+            }
+        }
+        break;
+    }
+
+    case topology_barabasi_albert: {
+        // ends has every POP once for each connection it has
+        uint32_t new_links = std::min(linksPerPop(parameters), num_pops - 1);
+        std::vector<uint32_t> ends;
+
+        // the first POPs are all connected to each other
+        for (uint32_t pop = 0; pop <= new_links; pop++) {
+            for (uint32_t other = 0; other < pop; other++) {
+                links.emplace_back(pop, other);
+                ends.push_back(pop);
+                ends.push_back(other);
+            }
+        }
+
+        std::vector<uint32_t> targets;
+        for (uint32_t pop = new_links + 1; pop < num_pops; pop++) {
+            targets.clear();
+            while (targets.size() < new_links) {
+                uint32_t target = ends[random() % ends.size()];
+                if (std::find(targets.begin(), targets.end(), target)
+                    == targets.end()) {
+                    targets.push_back(target);
+                }
+            }
+
+            for (uint32_t target : targets) {
+                links.emplace_back(pop, target);
+                ends.push_back(pop);
+                ends.push_back(target);
+            }
+        }
+        break;
+    }
+
+    case topology_grid: {
+        uint32_t side = std::ceil(std::sqrt((double)num_pops));
+        for (uint32_t pop = 0; pop < num_pops; pop++) {
+            if ((pop + 1) % side != 0 && pop + 1 < num_pops) {
+                links.emplace_back(pop, pop + 1);
+            }
+            if (pop + side < num_pops) {
+                links.emplace_back(pop, pop + side);
+            }
+        }
+        break;
+    }
+    }
+
+    return links;
+}
+
+/*
+ * appendPop appends an entry of the POP with index pop, connected to the POP
+ * with index connected (or to none, if it is -1) with speed given in unit.
+ */
+static void appendPop(Table& table, uint32_t pop, int32_t connected,
+    char unit, int32_t speed_value) {
+
+    std::string name = "POP" + std::to_string(pop + 1);
+    std::string country = COUNTRY_NAMES[pop % NUM_COUNTRIES];
+
+    entry es;
+    initEntry(&es);
+    es.fields[idConnect].value.integer = pop + 1;
+    std::memcpy(es.fields[countryAcro].value.carray,
+        COUNTRY_ACRONYMS[pop % NUM_COUNTRIES], 2);
+    es.fields[connPoPsId].value.integer
+        = connected == -1 ? NULL_INT : connected + 1;
+    es.fields[measurmentUnit].value.carray[0] = unit;
+    es.fields[speed].value.integer = speed_value;
+
+    // the strings are only read by appendEntry, never freed
+    es.fields[poPsName].value.cpointer = &name[0];
+    es.fields[countryName].value.cpointer = &country[0];
+    table.appendEntry(&es);
+}
+
+size_t writeTopology(
+    const char* file_name, const TopologyParameters& parameters) {
+
+    std::mt19937_64 random(parameters.seed);
+    std::vector<std::pair<uint32_t, uint32_t>> links
+        = generateLinks(parameters, random);
+
+    std::string name(file_name);
+    Table table(&name[0], "wb");
+
+    // speeds are drawn so that every unit gives about the same Mbps
+    std::discrete_distribution<int> units(parameters.unit_weights,
+        parameters.unit_weights + NUM_SPEED_UNITS);
+    std::uniform_int_distribution<int32_t> speeds(1, MAX_LINK_SPEED);
+
+    std::vector<bool> connected(parameters.num_pops, false);
+    for (auto& link : links) {
+        int unit = units(random);
+        int32_t speed_value = speeds(random);
+        if (SPEED_UNITS[unit] == 'K') {
+            speed_value *= 1024;
+        } else if (SPEED_UNITS[unit] == 'G') {
+            speed_value = (speed_value + 1023) / 1024;
+        }
+
+        appendPop(table, link.first, link.second, SPEED_UNITS[unit],
+            speed_value);
+        appendPop(table, link.second, link.first, SPEED_UNITS[unit],
+            speed_value);
+        connected[link.first] = true;
+        connected[link.second] = true;
+    }
+
+    for (uint32_t pop = 0; pop < parameters.num_pops; pop++) {
+        if (!connected[pop]) {
+            appendPop(table, pop, -1, '$', NULL_INT);
+        }
+    }
+
+    // remove a random sample of the entries
+    size_t num_entries = table.entryCount();
+    std::vector<size_t> rrns(num_entries);
+    for (size_t rrn = 0; rrn < num_entries; rrn++) {
+        rrns[rrn] = rrn;
+    }
+    std::shuffle(rrns.begin(), rrns.end(), random);
+
+    size_t num_removed = std::llround(num_entries * parameters.removed_ratio);
+    for (size_t i = 0; i < std::min(num_removed, num_entries); i++) {
+        table.removeEntry(rrns[i]);
+    }
+
+    return num_entries;
+}
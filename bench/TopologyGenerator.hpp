@@ -0,0 +1,79 @@
+#ifndef __TOPOLOGY_GENERATOR_HPP__
+#define __TOPOLOGY_GENERATOR_HPP__
+
+#include <cinttypes>
+#include <cstddef>
+#include <random>
+#include <utility>
+#include <vector>
+
+/*
+ * enum TopologyModel represents the shapes of network topologies the
+ * generator can make, see generateLinks.
+ */
+enum TopologyModel {
+    topology_ring = 0,
+    topology_mesh,
+    topology_barabasi_albert,
+    topology_grid
+};
+#define NUM_TOPOLOGY_MODELS 4
+
+// the units of connection speeds, in the same order as unit_weights.
+#define NUM_SPEED_UNITS 3
+#define SPEED_UNITS "KMG"
+
+/*
+ * struct TopologyParameters describes a synthetic topology: its number of
+ * POPs and their average number of connections, its model, the fraction of
+ * its entries that are removed after being written, how often each speed
+ * unit is used (weights for kilo, mega and gigabits, in any scale) and the
+ * seed of its random choices, so the same parameters always give the same
+ * table.
+ */
+struct TopologyParameters {
+    uint32_t num_pops;
+    double average_degree;
+    TopologyModel model;
+    double removed_ratio;
+    double unit_weights[NUM_SPEED_UNITS];
+    uint64_t seed;
+};
+
+/*
+ * topologyModelName returns the name of model, as taken by
+ * parseTopologyModel: "ring", "mesh", "barabasi-albert" or "grid".
+ */
+const char* topologyModelName(TopologyModel model);
+
+/*
+ * parseTopologyModel sets model to the model called name, returning false
+ * if there is none.
+ */
+bool parseTopologyModel(const char* name, TopologyModel& model);
+
+/*
+ * generateLinks returns the connections of a topology, as pairs of POP
+ * indices in [0, num_pops), made with random. Depending on the model:
+ *  - ring: each POP is connected to the average_degree / 2 next ones;
+ *  - mesh: connections join POPs chosen uniformly at random;
+ *  - barabasi-albert: each POP is connected to average_degree / 2 earlier
+ *    ones, chosen proportionally to how many connections they already have;
+ *  - grid: POPs are laid out in a square and connected to the ones next to
+ *    them, so the average degree is always close to 4.
+ */
+std::vector<std::pair<uint32_t, uint32_t>> generateLinks(
+    const TopologyParameters& parameters, std::mt19937_64& random);
+
+/*
+ * writeTopology writes the table named file_name (replacing it) with a
+ * topology generated as given by parameters, through Table::appendEntry and
+ * Table::removeEntry. Each connection is written in both directions, each
+ * POP without connections once without any, and then a removed_ratio of the
+ * entries is removed. It returns how many entries were written, removed ones
+ * included.
+ */
+size_t writeTopology(
+    const char* file_name, const TopologyParameters& parameters);
+
+#endif
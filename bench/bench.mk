@@ -0,0 +1,4 @@
+build/obj/bench/TopologyGenerator.o: bench/TopologyGenerator.hpp src/table.hpp src/entries.h src/EntryView.hpp
+build/obj/bench/benchmark.o: bench/TopologyGenerator.hpp src/table.hpp src/entries.h src/EntryView.hpp src/commands.hpp
+build/obj/bench/benchmark.o: src/NetworkSnapshot.hpp src/NetworkGraph.hpp src/Graph.hpp src/Graph.hxx src/CSRArray.hpp src/CSRArray.hxx src/InputBuffer.hpp src/utils.h src/Stats.hpp src/Trace.hpp
+build/obj/bench/codec/CodecBenchmark.o: src/entries.h src/utils.h
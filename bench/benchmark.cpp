@@ -0,0 +1,290 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#include "NetworkGraph.hpp"
+#include "TopologyGenerator.hpp"
+#include "commands.hpp"
+#include "table.hpp"
+
+extern "C" {
+#include "utils.h"
+}
+
+/*
+ * the defaults of the benchmark's options, see usage. Sizes are POP counts,
+ * kept small enough for a whole run to take well under a minute.
+ */
+#define DEFAULT_SIZES "1000,5000,20000"
+#define DEFAULT_MODELS "ring,mesh,barabasi-albert,grid"
+#define DEFAULT_DEGREE 4.0
+#define DEFAULT_REMOVED 0.05
+#define DEFAULT_UNITS "1,4,1"
+#define DEFAULT_QUERIES 50
+#define DEFAULT_SEED 1
+#define DEFAULT_DIRECTORY "build/bench"
+
+/*
+ * struct BenchOptions holds the options of a benchmark run: every model in
+ * models is generated once for every size in sizes, with the remaining
+ * parameters shared by all of them.
+ */
+struct BenchOptions {
+    std::vector<uint32_t> sizes;
+    std::vector<TopologyModel> models;
+    TopologyParameters parameters;
+    uint32_t num_queries;
+    std::string directory;
+};
+
+static void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " [--sizes n,...] [--models name,...] [--degree d]"
+                 " [--removed ratio] [--units k,m,g] [--queries n]"
+                 " [--seed n] [--dir path]\n"
+              << "models: " DEFAULT_MODELS "\n";
+    std::exit(EXIT_FAILURE);
+}
+
+// splitList returns the items of the comma separated list.
+static std::vector<std::string> splitList(const char* list) {
+    std::vector<std::string> items(1);
+    for (; *list != '\0'; list++) {
+        if (*list == ',') {
+            items.emplace_back();
+        } else {
+            items.back() += *list;
+        }
+    }
+
+    return items;
+}
+
+static void parseSizes(const char* list, BenchOptions& options) {
+    options.sizes.clear();
+    for (const std::string& item : splitList(list)) {
+        options.sizes.push_back(std::strtoul(item.c_str(), NULL, 10));
+    }
+}
+
+static bool parseModels(const char* list, BenchOptions& options) {
+    options.models.clear();
+    for (const std::string& item : splitList(list)) {
+        TopologyModel model;
+        if (!parseTopologyModel(item.c_str(), model)) {
+            return false;
+        }
+        options.models.push_back(model);
+    }
+
+    return true;
+}
+
+static bool parseUnits(const char* list, BenchOptions& options) {
+    std::vector<std::string> items = splitList(list);
+    if (items.size() != NUM_SPEED_UNITS) {
+        return false;
+    }
+
+    for (int unit = 0; unit < NUM_SPEED_UNITS; unit++) {
+        options.parameters.unit_weights[unit] = std::atof(items[unit].c_str());
+    }
+
+    return true;
+}
+
+static BenchOptions parseOptions(int argc, char** argv) {
+    BenchOptions options;
+    parseSizes(DEFAULT_SIZES, options);
+    parseModels(DEFAULT_MODELS, options);
+    parseUnits(DEFAULT_UNITS, options);
+    options.parameters.average_degree = DEFAULT_DEGREE;
+    options.parameters.removed_ratio = DEFAULT_REMOVED;
+    options.parameters.seed = DEFAULT_SEED;
+    options.num_queries = DEFAULT_QUERIES;
+    options.directory = DEFAULT_DIRECTORY;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+
+        const char* option = argv[i];
+        const char* value = argv[++i];
+        if (std::strcmp(option, "--sizes") == 0) {
+            parseSizes(value, options);
+        } else if (std::strcmp(option, "--models") == 0) {
+            if (!parseModels(value, options)) {
+                usage(argv[0]);
+            }
+        } else if (std::strcmp(option, "--degree") == 0) {
+            options.parameters.average_degree = std::atof(value);
+        } else if (std::strcmp(option, "--removed") == 0) {
+            options.parameters.removed_ratio = std::atof(value);
+        } else if (std::strcmp(option, "--units") == 0) {
+            if (!parseUnits(value, options)) {
+                usage(argv[0]);
+            }
+        } else if (std::strcmp(option, "--queries") == 0) {
+            options.num_queries = std::strtoul(value, NULL, 10);
+        } else if (std::strcmp(option, "--seed") == 0) {
+            options.parameters.seed = std::strtoull(value, NULL, 10);
+        } else if (std::strcmp(option, "--dir") == 0) {
+            options.directory = value;
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    return options;
+}
+
+/*
+ * class PhaseTimer measures the wall time of the phases of a benchmark,
+ * writing each one as a member of a JSON object to out.
+ */
+class PhaseTimer {
+private:
+    std::ostream& out;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    // begin starts timing a phase.
+    void begin() { start = std::chrono::steady_clock::now(); }
+
+    // end writes the seconds since begin as the member name.
+    void end(const char* name) {
+        std::chrono::duration<double> elapsed
+            = std::chrono::steady_clock::now() - start;
+        out << ", \"" << name << "\": " << elapsed.count();
+    }
+
+    PhaseTimer(std::ostream& out) : out(out) {}
+};
+
+/*
+ * scanTable reads every entry of table through views, as every command does
+ * before building its graph, returning how many are not removed.
+ */
+static size_t scanTable(const Table& table) {
+    size_t num_entries = table.entryCount();
+    char buffer[MAX_SIZE_ENTRY];
+    size_t num_valid = 0;
+
+    for (size_t rrn = 0; rrn < num_entries; rrn++) {
+        EntryView view;
+        if (table.viewEntry(rrn, view, buffer) && !view.isRemoved()) {
+            num_valid++;
+        }
+    }
+
+    return num_valid;
+}
+
+/*
+ * runBenchmark generates the topology of parameters in file_name and times
+ * every phase of reading it and answering commands over it, writing them as
+ * a JSON object to out.
+ */
+static void runBenchmark(const BenchOptions& options,
+    const TopologyParameters& parameters, const std::string& file_name,
+    std::ostream& out) {
+
+    PhaseTimer timer(out);
+    out << "{\"model\": \"" << topologyModelName(parameters.model)
+        << "\", \"pops\": " << parameters.num_pops;
+
+    timer.begin();
+    size_t num_entries = writeTopology(file_name.c_str(), parameters);
+    timer.end("generate");
+    out << ", \"entries\": " << num_entries;
+
+    std::string name(file_name);
+    Table table(&name[0], "rb");
+
+    timer.begin();
+    size_t num_valid = scanTable(table);
+    timer.end("scan");
+    out << ", \"valid_entries\": " << num_valid;
+
+    timer.begin();
+    NetworkGraph graph(table);
+    timer.end("build");
+
+    std::ofstream discarded("/dev/null");
+
+    timer.begin();
+    commandPrint(graph, discarded);
+    timer.end("print");
+
+    timer.begin();
+    commandNumCicles(graph, discarded);
+    timer.end("cicles");
+
+    // queries go between random POPs, some of them removed or missing
+    std::mt19937_64 random(parameters.seed);
+    std::uniform_int_distribution<int32_t> any_pop(1, parameters.num_pops);
+    std::vector<int32_t> origins(options.num_queries);
+    std::vector<int32_t> destinations(options.num_queries);
+    std::vector<int32_t> stops(options.num_queries);
+    for (uint32_t i = 0; i < options.num_queries; i++) {
+        origins[i] = any_pop(random);
+        destinations[i] = any_pop(random);
+        stops[i] = any_pop(random);
+    }
+
+    timer.begin();
+    answerMaxSpeeds(graph, origins, destinations, discarded);
+    timer.end("max_speed");
+
+    timer.begin();
+    answerLengths(graph, origins, destinations, stops, discarded);
+    timer.end("length");
+
+    out << ", \"queries\": " << options.num_queries << "}";
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options = parseOptions(argc, argv);
+
+    if (mkdir(options.directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        ABORT_PROGRAM("directory %s", options.directory.c_str());
+    }
+
+    const TopologyParameters& base = options.parameters;
+    std::cout << "{\"degree\": " << base.average_degree
+              << ", \"removed\": " << base.removed_ratio << ", \"units\": ["
+              << base.unit_weights[0] << ", " << base.unit_weights[1] << ", "
+              << base.unit_weights[2] << "], \"seed\": " << base.seed
+              << ",\n \"runs\": [";
+
+    const char* separator = "\n  ";
+    for (TopologyModel model : options.models) {
+        for (uint32_t size : options.sizes) {
+            TopologyParameters parameters = options.parameters;
+            parameters.model = model;
+            parameters.num_pops = size;
+
+            std::cerr << "benchmarking " << topologyModelName(model) << " with "
+                      << size << " POPs\n";
+
+            std::string file_name = options.directory + "/"
+                + topologyModelName(model) + "-" + std::to_string(size)
+                + ".bin";
+
+            std::cout << separator;
+            runBenchmark(options, parameters, file_name, std::cout);
+            std::cout.flush();
+            separator = ",\n  ";
+        }
+    }
+
+    std::cout << "\n]}\n";
+    return 0;
+}
@@ -0,0 +1,391 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+extern "C" {
+#include "entries.h"
+#include "utils.h"
+}
+
+/*
+ * the defaults of the benchmark's options, see usage. Every function is run
+ * over all records once per repeat, and the fastest repeat is reported.
+ */
+#define DEFAULT_RECORDS 100000
+#define DEFAULT_REPEATS 5
+#define DEFAULT_SEED 1
+#define DEFAULT_DIRECTORY "build/bench"
+
+// the file the on-disk records are written to, inside the directory.
+#define CODEC_FILE_NAME "codec.bin"
+
+// the share of records written as removed, which readEntry skips.
+#define CODEC_REMOVED_RATIO 0.05
+
+// how many entries readEntries decodes at once.
+#define CODEC_ARENA_CAPACITY 1024
+
+// the offsets of the fields read alone by readField within a record.
+#define ID_CONNECT_OFFSET 5
+#define POPS_NAME_OFFSET 20
+
+static const char* const COUNTRY_ACRONYMS[] = { "BR", "AR", "CL", "US", "DE" };
+static const char* const COUNTRY_NAMES[]
+    = { "Brasil", "Argentina", "Chile", "Estados Unidos", "Alemanha" };
+#define NUM_COUNTRIES 5
+
+/*
+ * The codec is linked with malloc, calloc, realloc and free wrapped (see
+ * bench-codec in the Makefile), so every heap call made by entries.c and
+ * utils.c goes through these and is counted. Calls made by the C++ standard
+ * library are not wrapped.
+ */
+static size_t num_allocations = 0;
+static size_t num_frees = 0;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t amount, size_t size);
+void* __real_realloc(void* p, size_t size);
+void __real_free(void* p);
+
+void* __wrap_malloc(size_t size) {
+    num_allocations++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t amount, size_t size) {
+    num_allocations++;
+    return __real_calloc(amount, size);
+}
+
+void* __wrap_realloc(void* p, size_t size) {
+    num_allocations++;
+    return __real_realloc(p, size);
+}
+
+void __wrap_free(void* p) {
+    if (p != NULL) {
+        num_frees++;
+    }
+    __real_free(p);
+}
+}
+
+/*
+ * struct CodecOptions holds the options of a benchmark run.
+ */
+struct CodecOptions {
+    size_t num_records;
+    uint32_t num_repeats;
+    uint64_t seed;
+    std::string directory;
+};
+
+/*
+ * struct CodecBench is the state shared by every function benchmarked:
+ * entries are the records decoded, and records their bytes as they are
+ * stored in a table, which the memory stream reads from and writes to. The
+ * disk stream does the same over a file with the same records.
+ */
+struct CodecBench {
+    std::vector<entry> entries;
+    std::vector<char> records;
+    FILE* memory;
+    FILE* disk;
+    size_t num_records;
+    uint32_t num_repeats;
+    volatile int64_t sink; // keeps results from being optimized away.
+};
+
+static void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " [--records n] [--repeats n] [--seed n] [--dir path]\n";
+    std::exit(EXIT_FAILURE);
+}
+
+static CodecOptions parseOptions(int argc, char** argv) {
+    CodecOptions options;
+    options.num_records = DEFAULT_RECORDS;
+    options.num_repeats = DEFAULT_REPEATS;
+    options.seed = DEFAULT_SEED;
+    options.directory = DEFAULT_DIRECTORY;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+
+        const char* option = argv[i];
+        const char* value = argv[++i];
+        if (std::strcmp(option, "--records") == 0) {
+            options.num_records = std::strtoull(value, NULL, 10);
+        } else if (std::strcmp(option, "--repeats") == 0) {
+            options.num_repeats = std::strtoul(value, NULL, 10);
+        } else if (std::strcmp(option, "--seed") == 0) {
+            options.seed = std::strtoull(value, NULL, 10);
+        } else if (std::strcmp(option, "--dir") == 0) {
+            options.directory = value;
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (options.num_records == 0 || options.num_repeats == 0) {
+        usage(argv[0]);
+    }
+
+    return options;
+}
+
+/*
+ * generateEntries fills bench.entries with num_records random entries, some
+ * of them removed, owning their strings.
+ */
+static void generateEntries(CodecBench& bench, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    std::uniform_int_distribution<int32_t> ids(1, 1000000);
+    std::uniform_int_distribution<int32_t> speeds(1, 1000);
+    std::bernoulli_distribution removals(CODEC_REMOVED_RATIO);
+
+    bench.entries.resize(bench.num_records);
+    for (entry& es : bench.entries) {
+        initEntry(&es);
+        int32_t id = ids(random);
+        int country = id % NUM_COUNTRIES;
+
+        if (removals(random)) {
+            es.fields[removed].value.carray[0] = REMOVED;
+        }
+        es.fields[idConnect].value.integer = id;
+        std::memcpy(es.fields[countryAcro].value.carray,
+            COUNTRY_ACRONYMS[country], 2);
+        es.fields[connPoPsId].value.integer = ids(random);
+        es.fields[measurmentUnit].value.carray[0] = "KMG"[id % 3];
+        es.fields[speed].value.integer = speeds(random);
+        es.fields[poPsName].value.cpointer
+            = strdup(("POP" + std::to_string(id)).c_str());
+        es.fields[countryName].value.cpointer = strdup(COUNTRY_NAMES[country]);
+    }
+}
+
+/*
+ * openStreams writes the entries to bench.records, read and written through
+ * an in-memory stream, and to the file named file_name, opened for reading
+ * and writing.
+ */
+static void openStreams(CodecBench& bench, const std::string& file_name) {
+    bench.records.assign(bench.num_records * MAX_SIZE_ENTRY, '$');
+    bench.memory
+        = fmemopen(bench.records.data(), bench.records.size(), "r+");
+    if (bench.memory == NULL) {
+        ABORT_PROGRAM("fmemopen");
+    }
+
+    bench.disk = std::fopen(file_name.c_str(), "w+b");
+    if (bench.disk == NULL) {
+        ABORT_PROGRAM("file %s", file_name.c_str());
+    }
+
+    for (entry& es : bench.entries) {
+        writeEntry(bench.memory, &es);
+        writeEntry(bench.disk, &es);
+    }
+    std::fflush(bench.memory);
+    std::fflush(bench.disk);
+}
+
+/*
+ * measure runs pass, which must go over every record once, bench.num_repeats
+ * times, writing the fastest one as a JSON object to out along with the
+ * allocations and frees of that pass, all per record.
+ */
+template <class Pass>
+static void measure(CodecBench& bench, const char* function,
+    const char* medium, Pass pass, std::ostream& out) {
+
+    double best = 0;
+    size_t allocations = 0;
+    size_t frees = 0;
+
+    for (uint32_t repeat = 0; repeat < bench.num_repeats; repeat++) {
+        size_t first_allocations = num_allocations;
+        size_t first_frees = num_frees;
+        auto start = std::chrono::steady_clock::now();
+
+        pass();
+
+        std::chrono::duration<double, std::nano> elapsed
+            = std::chrono::steady_clock::now() - start;
+        if (repeat == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+        allocations = num_allocations - first_allocations;
+        frees = num_frees - first_frees;
+    }
+
+    double num_records = bench.num_records;
+    out << "{\"function\": \"" << function << "\", \"medium\": \"" << medium
+        << "\", \"ns_per_record\": " << best / num_records
+        << ", \"allocations_per_record\": " << allocations / num_records
+        << ", \"frees_per_record\": " << frees / num_records << "}";
+}
+
+// readAllEntries decodes every record of fp with readEntry.
+static void readAllEntries(CodecBench& bench, FILE* fp) {
+    std::rewind(fp);
+    entry es;
+    initEntry(&es);
+
+    for (size_t rrn = 0; rrn < bench.num_records; rrn++) {
+        readEntry(fp, &es);
+        bench.sink = bench.sink + es.fields[idConnect].value.integer;
+        clearEntry(&es);
+    }
+}
+
+// readAllFields reads the field at offset of every record of fp alone.
+static void readAllFields(
+    CodecBench& bench, FILE* fp, FieldsTypes type, long offset) {
+
+    field f;
+    f.field_type = type;
+
+    for (size_t rrn = 0; rrn < bench.num_records; rrn++) {
+        std::fseek(fp, rrn * MAX_SIZE_ENTRY + offset, SEEK_SET);
+        readField(fp, &f, offset);
+        if (type == poPsName) {
+            bench.sink = bench.sink + f.value.cpointer[0];
+            std::free(f.value.cpointer);
+        } else {
+            bench.sink = bench.sink + f.value.integer;
+        }
+    }
+}
+
+// readAllBatches decodes every record of fp with readEntries.
+static void readAllBatches(CodecBench& bench, FILE* fp) {
+    std::rewind(fp);
+    entryArena* arena = createEntryArena(CODEC_ARENA_CAPACITY);
+
+    uint32_t amount;
+    while ((amount = readEntries(fp, arena, CODEC_ARENA_CAPACITY)) > 0) {
+        bench.sink = bench.sink + arena->entries[amount - 1].fields[0]
+                                      .value.carray[0];
+        resetEntryArena(arena);
+    }
+
+    deleteEntryArena(arena);
+}
+
+// writeAllEntries encodes every entry to fp with writeEntry.
+static void writeAllEntries(CodecBench& bench, FILE* fp) {
+    std::rewind(fp);
+    for (entry& es : bench.entries) {
+        writeEntry(fp, &es);
+    }
+    std::fflush(fp);
+}
+
+/*
+ * runBenchmarks measures every function of the codec over the records in
+ * memory and, for the ones that use streams, on disk, writing a JSON array
+ * of their results to out.
+ */
+static void runBenchmarks(CodecBench& bench, std::ostream& out) {
+    const char* separator = "\n  ";
+    auto result = [&](const char* function, const char* medium, auto pass) {
+        out << separator;
+        measure(bench, function, medium, pass, out);
+        out.flush();
+        separator = ",\n  ";
+    };
+
+    const char* media[] = { "memory", "disk" };
+    FILE* streams[] = { bench.memory, bench.disk };
+
+    out << "[";
+    for (int i = 0; i < 2; i++) {
+        FILE* fp = streams[i];
+        result("writeEntry", media[i], [&]() { writeAllEntries(bench, fp); });
+        result("readEntry", media[i], [&]() { readAllEntries(bench, fp); });
+        result("readField(idConnect)", media[i], [&]() {
+            readAllFields(bench, fp, idConnect, ID_CONNECT_OFFSET);
+        });
+        result("readField(poPsName)", media[i], [&]() {
+            readAllFields(bench, fp, poPsName, POPS_NAME_OFFSET);
+        });
+        result("readEntries", media[i], [&]() { readAllBatches(bench, fp); });
+    }
+
+    result("readEntryFromBuffer", "memory", [&]() {
+        entry es;
+        initEntry(&es);
+        for (size_t rrn = 0; rrn < bench.num_records; rrn++) {
+            readEntryFromBuffer(&bench.records[rrn * MAX_SIZE_ENTRY], &es);
+            bench.sink = bench.sink + es.fields[idConnect].value.integer;
+            clearEntry(&es);
+        }
+    });
+
+    result("copyEntry", "memory", [&]() {
+        entry copy;
+        initEntry(&copy);
+        for (entry& es : bench.entries) {
+            copyEntry(&copy, &es);
+            bench.sink = bench.sink + copy.fields[speed].value.integer;
+        }
+        clearEntry(&copy);
+    });
+
+    // each entry is compared field by field to the next one
+    result("fieldCmp", "memory", [&]() {
+        for (size_t rrn = 0; rrn < bench.num_records; rrn++) {
+            entry& es = bench.entries[rrn];
+            entry& next = bench.entries[(rrn + 1) % bench.num_records];
+            for (uint32_t i = idConnect; i < FIELD_AMOUNT; i++) {
+                bench.sink
+                    = bench.sink + fieldCmp(es.fields[i], next.fields[i]);
+            }
+        }
+    });
+    out << "\n]";
+}
+
+int main(int argc, char** argv) {
+    CodecOptions options = parseOptions(argc, argv);
+
+    if (mkdir(options.directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        ABORT_PROGRAM("directory %s", options.directory.c_str());
+    }
+
+    CodecBench bench;
+    bench.num_records = options.num_records;
+    bench.num_repeats = options.num_repeats;
+    bench.sink = 0;
+
+    generateEntries(bench, options.seed);
+    std::string file_name = options.directory + "/" CODEC_FILE_NAME;
+    openStreams(bench, file_name);
+
+    std::cout << "{\"records\": " << bench.num_records
+              << ", \"repeats\": " << bench.num_repeats
+              << ", \"seed\": " << options.seed << ",\n \"results\": ";
+    runBenchmarks(bench, std::cout);
+    std::cout << "}\n";
+
+    std::fclose(bench.memory);
+    std::fclose(bench.disk);
+    std::remove(file_name.c_str());
+    for (entry& es : bench.entries) {
+        clearEntry(&es);
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef __CSR_ARRAY_HPP__
+#define __CSR_ARRAY_HPP__
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * template<T> CSRArray is a read-only array of the CSR layout of Graph. Its
+ * elements are either owned by it, when the layout is built in memory, or
+ * viewed in place in memory owned by someone else, e.g. a memory mapped
+ * graph file (see GraphFile), so a graph can be queried without copying it.
+ * Copies of an array that views memory view the same memory.
+ */
+template <class T> class CSRArray {
+private:
+    std::vector<T> owned; // the elements, unless they are viewed.
+    const T* items; // the first element, in owned or in the memory viewed.
+    size_t num_items;
+
+public:
+    // assign makes the array own values, which it takes.
+    void assign(std::vector<T>&& values);
+
+    /*
+     * view makes the array view the size elements at items, which must stay
+     * valid (and unchanged) while they are viewed.
+     */
+    void view(const T* items, size_t size);
+
+    /*
+     * own copies the elements viewed, if any, so the array no longer depends
+     * on the memory it viewed.
+     */
+    void own();
+
+    const T& operator[](size_t index) const;
+    size_t size() const;
+    bool empty() const;
+    const T* data() const;
+    const T* begin() const;
+    const T* end() const;
+
+    CSRArray(); // Constructs an empty array.
+    CSRArray(const CSRArray& array);
+    CSRArray(CSRArray&& array);
+    CSRArray& operator=(const CSRArray& array);
+    CSRArray& operator=(CSRArray&& array);
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef __CSR_ARRAY_HXX__
+#define __CSR_ARRAY_HXX__
+
+#include <utility>
+
+#include "CSRArray.hpp"
+
+template <class T> void CSRArray<T>::assign(std::vector<T>&& values) {
+    owned = std::move(values);
+    items = owned.data();
+    num_items = owned.size();
+}
+
+template <class T> void CSRArray<T>::view(const T* items, size_t size) {
+    owned.clear();
+    owned.shrink_to_fit();
+    this->items = items;
+    num_items = size;
+}
+
+template <class T> void CSRArray<T>::own() {
+    if (items != owned.data()) {
+        assign(std::vector<T>(begin(), end()));
+    }
+}
+
+template <class T>
+const T& CSRArray<T>::operator[](size_t index) const {
+    return items[index];
+}
+
+template <class T> size_t CSRArray<T>::size() const { return num_items; }
+
+template <class T> bool CSRArray<T>::empty() const { return num_items == 0; }
+
+template <class T> const T* CSRArray<T>::data() const { return items; }
+
+template <class T> const T* CSRArray<T>::begin() const { return items; }
+
+template <class T> const T* CSRArray<T>::end() const {
+    return items + num_items;
+}
+
+template <class T> CSRArray<T>::CSRArray() {
+    items = NULL;
+    num_items = 0;
+}
+
+template <class T> CSRArray<T>::CSRArray(const CSRArray& array) {
+    *this = array;
+}
+
+template <class T> CSRArray<T>::CSRArray(CSRArray&& array) {
+    *this = std::move(array);
+}
+
+template <class T>
+CSRArray<T>& CSRArray<T>::operator=(const CSRArray& array) {
+    // copies of a view view the same memory, see CSRArray
+    if (this == &array) {
+        return *this;
+    } else if (array.items != array.owned.data()) {
+        view(array.items, array.num_items);
+    } else {
+        assign(std::vector<T>(array.owned));
+    }
+
+    return *this;
+}
+
+template <class T> CSRArray<T>& CSRArray<T>::operator=(CSRArray&& array) {
+    if (this == &array) {
+        return *this;
+    } else if (array.items != array.owned.data()) {
+        view(array.items, array.num_items);
+    } else {
+        assign(std::move(array.owned));
+    }
+
+    array.view(NULL, 0);
+    return *this;
+}
+
+#endif
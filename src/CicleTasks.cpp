@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <thread>
+
+#include "CicleTasks.hpp"
+
+void CicleTasks::push(uint32_t thread, const CicleTask& task) {
+    // the task is pending before anyone can pop it
+    pending++;
+
+    std::lock_guard<std::mutex> guard(deques[thread]->lock);
+    deques[thread]->tasks.push_back(task);
+}
+
+bool CicleTasks::pop(uint32_t thread, CicleTask& task) {
+    while (!stopped) {
+        // first, the newest task of the thread's own deque
+        {
+            std::lock_guard<std::mutex> guard(deques[thread]->lock);
+            if (!deques[thread]->tasks.empty()) {
+                task = deques[thread]->tasks.back();
+                deques[thread]->tasks.pop_back();
+                return true;
+            }
+        }
+
+        // then, the oldest task of any other deque
+        for (size_t i = 1; i < deques.size(); i++) {
+            Deque& victim = *deques[(thread + i) % deques.size()];
+
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+
+        // nothing to steal, but running tasks may still push new ones
+        if (pending == 0) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+
+    return false;
+}
+
+void CicleTasks::finish() { pending--; }
+
+bool CicleTasks::takeBudget(uint64_t& local_budget) {
+    uint64_t available = budget;
+    uint64_t taken;
+    do {
+        if (available == 0) {
+            stopped = true;
+            return false;
+        }
+
+        taken = std::min<uint64_t>(available, CICLE_BUDGET_CHUNK);
+    } while (!budget.compare_exchange_weak(available, available - taken));
+
+    local_budget += taken;
+    return true;
+}
+
+bool CicleTasks::isStopped() const { return stopped; }
+
+CicleTasks::CicleTasks(uint32_t num_threads, uint64_t budget)
+    : pending(0), stopped(false), budget(budget) {
+    for (uint32_t i = 0; i < num_threads; i++) {
+        deques.push_back(std::unique_ptr<Deque>(new Deque()));
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef __CICLE_TASKS_HPP__
+#define __CICLE_TASKS_HPP__
+
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+ * the amount of budget (edges to walk) a thread takes from CicleTasks' shared
+ * budget at once, so that threads rarely touch it.
+ */
+#define CICLE_BUDGET_CHUNK 4096
+
+/*
+ * struct CicleTask is a part of Graph's cicle count: walking every path with
+ * increasing indices from node_index that can close a cicle at start_index,
+ * where node_index is depth edges away from the path's first node.
+ */
+struct CicleTask {
+    uint32_t start_index;
+    uint32_t node_index;
+    uint32_t depth;
+};
+
+/*
+ * class CicleTasks is a work-stealing pool of CicleTasks, with one deque per
+ * thread. Each thread pushes and pops its own tasks from the back of its
+ * deque, so it walks the paths depth first, while idle threads steal the
+ * oldest tasks (the ones with the largest subtrees) from the front of the
+ * others' deques. Each deque has its own lock, so threads only contend when
+ * stealing. The pool also holds the budget shared by all threads.
+ */
+class CicleTasks {
+private:
+    // Deque is a thread's deque, with the lock that protects it.
+    struct Deque {
+        std::mutex lock;
+        std::deque<CicleTask> tasks;
+    };
+
+    std::vector<std::unique_ptr<Deque>> deques;
+
+    // tasks pushed and not yet finished, in any deque or being run.
+    std::atomic<size_t> pending;
+    std::atomic<bool> stopped; // whether the threads must stop early.
+    std::atomic<uint64_t> budget; // edges left to walk by all threads.
+
+public:
+    // push adds task to the deque of thread.
+    void push(uint32_t thread, const CicleTask& task);
+
+    /*
+     * pop takes a task for thread, from its own deque or stolen from the
+     * other ones, waiting while other threads may still push new tasks. It
+     * returns false when every task is finished or the pool was stopped.
+     */
+    bool pop(uint32_t thread, CicleTask& task);
+
+    void finish(); // finish marks a task popped before as finished.
+
+    /*
+     * takeBudget moves up to CICLE_BUDGET_CHUNK of the shared budget to
+     * local_budget. If the shared budget ran out, it stops the pool and
+     * returns false.
+     */
+    bool takeBudget(uint64_t& local_budget);
+
+    // isStopped returns whether the budget ran out before every task finished.
+    bool isStopped() const;
+
+    /*
+     * Constructs a pool with no tasks for num_threads threads, that may walk
+     * up to budget edges.
+     */
+    CicleTasks(uint32_t num_threads, uint64_t budget);
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include <cstring>
+
+#include "EntryView.hpp"
+
+int32_t EntryView::readInteger(size_t offset) const {
+    // records are not aligned, so copy instead of casting the pointer
+    int32_t value;
+    std::memcpy(&value, record + offset, sizeof(int32_t));
+    return value;
+}
+
+bool EntryView::isRemoved() const { return record[REMOVED_OFFSET] == REMOVED; }
+
+int32_t EntryView::nextStackRRN() const { return readInteger(LINKING_OFFSET); }
+
+int32_t EntryView::idConnect() const { return readInteger(IDCONNECT_OFFSET); }
+
+int32_t EntryView::connPoPsId() const { return readInteger(CONNPOPSID_OFFSET); }
+
+int32_t EntryView::speed() const { return readInteger(SPEED_OFFSET); }
+
+const char* EntryView::countryAcro() const {
+    return record + COUNTRYACRO_OFFSET;
+}
+
+char EntryView::measurementUnit() const {
+    return record[MEASUREMENT_UNIT_OFFSET];
+}
+
+std::string_view EntryView::poPsName() const { return pops_name; }
+
+std::string_view EntryView::countryName() const { return country_name; }
+
+EntryView::EntryView(const char* record) {
+    this->record = record;
+    if (isRemoved()) {
+        // removed entries only have meta fields, the rest is trash
+        return;
+    }
+
+    const char* end = record + MAX_SIZE_ENTRY;
+    const char* start = record + VARIABLE_FIELDS_OFFSET;
+
+    // the POP's name ends with '|' or at the end of the entry
+    const char* sep = (const char*)std::memchr(start, '|', end - start);
+    pops_name = std::string_view(start, (sep ? sep : end) - start);
+    if (sep == NULL || sep + 1 >= end) {
+        return; // no space left for the country's name
+    }
+
+    start = sep + 1;
+    sep = (const char*)std::memchr(start, '|', end - start);
+    country_name = std::string_view(start, (sep ? sep : end) - start);
+}
+
+EntryView::EntryView() { record = NULL; }
@@ -0,0 +1,70 @@
+#ifndef __ENTRY_VIEW_HPP__
+#define __ENTRY_VIEW_HPP__
+
+#include <cinttypes>
+#include <string_view>
+
+extern "C" {
+#include "entries.h"
+}
+
+// Byte offsets of each fixed sized field inside a MAX_SIZE_ENTRY record.
+#define REMOVED_OFFSET 0
+#define LINKING_OFFSET 1
+#define IDCONNECT_OFFSET 5
+#define COUNTRYACRO_OFFSET 9
+#define CONNPOPSID_OFFSET 11
+#define MEASUREMENT_UNIT_OFFSET 15
+#define SPEED_OFFSET 16
+#define VARIABLE_FIELDS_OFFSET 20
+
+/*
+ * class EntryView is a non-owning, read-only view of a single entry as it is
+ * stored in a binary table (MAX_SIZE_ENTRY bytes, in the same order as the
+ * FieldsTypes enum). It does not allocate anything: fixed sized fields are
+ * decoded on access and variable sized fields are string_views into the
+ * record bytes, so a view is only valid while those bytes are.
+ *
+ * Its accessors mirror the GET_* macros in entries.h.
+ */
+class EntryView {
+private:
+    const char* record; // the raw record bytes, NULL for an empty view.
+    std::string_view pops_name; // POP's name, inside record.
+    std::string_view country_name; // country's name, inside record.
+
+    // readInteger decodes the 4 byte integer at offset of the record.
+    int32_t readInteger(size_t offset) const;
+
+public:
+    bool isRemoved() const; // isRemoved mirrors ENTRY_REMOVED.
+    int32_t nextStackRRN() const; // nextStackRRN mirrors GET_NEXT_STACK_RRN.
+    int32_t idConnect() const; // idConnect mirrors GET_IDCONNECT.
+    int32_t connPoPsId() const; // connPoPsId mirrors GET_CONNPOPSID.
+    int32_t speed() const; // speed mirrors GET_SPEED.
+
+    /*
+     * countryAcro mirrors GET_COUNTRYACRO, returning a pointer to the 2
+     * characters of the acronym. It is NOT null terminated.
+     */
+    const char* countryAcro() const;
+
+    /*
+     * measurementUnit mirrors GET_MEASUREMENT_UNIT, but returns the unit
+     * character itself.
+     */
+    char measurementUnit() const;
+
+    std::string_view poPsName() const; // poPsName mirrors GET_POPSNAME.
+    std::string_view countryName() const; // countryName mirrors GET_COUNTRYNAME
+
+    /*
+     * EntryView(record) constructs a view of the MAX_SIZE_ENTRY bytes at
+     * record. Variable sized fields are delimited in the same way readEntry
+     * does: by '|' or by the end of the entry.
+     */
+    EntryView(const char* record);
+    EntryView(); // Constructs an empty view, that must not be accessed.
+};
+
+#endif
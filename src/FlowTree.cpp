@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <sys/stat.h>
+
+#include "FlowTree.hpp"
+
+// the size of a saved tree's header: magic, graph hash and number of nodes.
+#define FLOW_TREE_HEADER_SIZE                                                  \
+    (FLOW_TREE_MAGIC_SIZE + sizeof(uint64_t) + sizeof(uint32_t))
+
+void FlowTree::buildAncestors() {
+    size_t num_nodes = parents.size();
+
+    // parents always come before their children
+    depths.assign(num_nodes, 0);
+    for (size_t node = 1; node < num_nodes; node++) {
+        depths[node] = depths[parents[node]] + 1;
+    }
+
+    ancestors.assign(1, parents);
+    min_flows.assign(1, flows);
+    if (num_nodes > 0) {
+        min_flows[0][0] = std::numeric_limits<double>::infinity();
+    }
+
+    uint32_t max_depth = 0;
+    for (uint32_t depth : depths) {
+        max_depth = std::max(max_depth, depth);
+    }
+
+    // each level jumps twice as far as the previous one
+    for (size_t level = 1; ((size_t)1 << level) <= max_depth; level++) {
+        std::vector<uint32_t>& half = ancestors[level - 1];
+        std::vector<double>& half_flows = min_flows[level - 1];
+
+        std::vector<uint32_t> next(num_nodes);
+        std::vector<double> next_flows(num_nodes);
+        for (size_t node = 0; node < num_nodes; node++) {
+            next[node] = half[half[node]];
+            next_flows[node]
+                = std::min(half_flows[node], half_flows[half[node]]);
+        }
+
+        ancestors.push_back(next);
+        min_flows.push_back(next_flows);
+    }
+}
+
+void FlowTree::build(const std::vector<uint32_t>& parents,
+    const std::vector<double>& flows, uint64_t graph_hash) {
+
+    this->parents = parents;
+    this->flows = flows;
+    this->graph_hash = graph_hash;
+    buildAncestors();
+}
+
+bool FlowTree::empty() const { return parents.size() == 0; }
+
+void FlowTree::clear() {
+    parents.clear();
+    flows.clear();
+    depths.clear();
+    ancestors.clear();
+    min_flows.clear();
+    graph_hash = 0;
+}
+
+uint64_t FlowTree::graphHash() const { return graph_hash; }
+
+double FlowTree::minFlow(uint32_t node_a, uint32_t node_b) const {
+    double flow = std::numeric_limits<double>::infinity();
+    if (depths[node_a] < depths[node_b]) {
+        std::swap(node_a, node_b);
+    }
+
+    // first, lift node_a up to the same depth as node_b
+    uint32_t difference = depths[node_a] - depths[node_b];
+    for (size_t level = 0; difference > 0; level++, difference >>= 1) {
+        if (difference & 1) {
+            flow = std::min(flow, min_flows[level][node_a]);
+            node_a = ancestors[level][node_a];
+        }
+    }
+
+    if (node_a == node_b) {
+        return flow;
+    }
+
+    // then lift both up to the children of their lowest common ancestor
+    for (size_t level = ancestors.size(); level-- > 0;) {
+        if (ancestors[level][node_a] != ancestors[level][node_b]) {
+            flow = std::min(flow, min_flows[level][node_a]);
+            flow = std::min(flow, min_flows[level][node_b]);
+            node_a = ancestors[level][node_a];
+            node_b = ancestors[level][node_b];
+        }
+    }
+
+    flow = std::min(flow, flows[node_a]);
+    return std::min(flow, flows[node_b]);
+}
+
+bool FlowTree::save(FILE* fp) const {
+    uint32_t num_nodes = parents.size();
+
+    bool ok = std::fwrite(FLOW_TREE_MAGIC, FLOW_TREE_MAGIC_SIZE, 1, fp) == 1;
+    ok = ok && std::fwrite(&graph_hash, sizeof(uint64_t), 1, fp) == 1;
+    ok = ok && std::fwrite(&num_nodes, sizeof(uint32_t), 1, fp) == 1;
+    ok = ok
+        && std::fwrite(parents.data(), sizeof(uint32_t), num_nodes, fp)
+            == num_nodes;
+    ok = ok
+        && std::fwrite(flows.data(), sizeof(double), num_nodes, fp)
+            == num_nodes;
+
+    return ok;
+}
+
+bool FlowTree::load(FILE* fp, uint32_t num_nodes, uint64_t graph_hash) {
+    clear();
+
+    // the file must hold exactly the header and both arrays
+    struct stat file_stat;
+    if (fstat(fileno(fp), &file_stat) != 0
+        || (uint64_t)file_stat.st_size != FLOW_TREE_HEADER_SIZE
+                + (uint64_t)num_nodes * (sizeof(uint32_t) + sizeof(double))) {
+        return false;
+    }
+
+    char magic[FLOW_TREE_MAGIC_SIZE];
+    uint64_t saved_hash;
+    uint32_t saved_nodes;
+    if (std::fread(magic, FLOW_TREE_MAGIC_SIZE, 1, fp) != 1
+        || std::memcmp(magic, FLOW_TREE_MAGIC, FLOW_TREE_MAGIC_SIZE) != 0
+        || std::fread(&saved_hash, sizeof(uint64_t), 1, fp) != 1
+        || std::fread(&saved_nodes, sizeof(uint32_t), 1, fp) != 1
+        || saved_hash != graph_hash || saved_nodes != num_nodes) {
+        return false;
+    }
+
+    std::vector<uint32_t> new_parents(num_nodes);
+    std::vector<double> new_flows(num_nodes);
+    if (std::fread(new_parents.data(), sizeof(uint32_t), num_nodes, fp)
+            != num_nodes
+        || std::fread(new_flows.data(), sizeof(double), num_nodes, fp)
+            != num_nodes) {
+        return false;
+    }
+
+    // parents must come before their children for the tree to be valid
+    for (uint32_t node = 1; node < num_nodes; node++) {
+        if (new_parents[node] >= node) {
+            return false;
+        }
+    }
+
+    build(new_parents, new_flows, graph_hash);
+    return true;
+}
+
+FlowTree::FlowTree() { graph_hash = 0; }
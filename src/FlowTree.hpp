@@ -0,0 +1,71 @@
+#ifndef __FLOW_TREE_HPP__
+#define __FLOW_TREE_HPP__
+
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+#define FLOW_TREE_MAGIC "FLWTREE1"
+#define FLOW_TREE_MAGIC_SIZE 8
+
+/*
+ * class FlowTree is a Gomory-Hu (equivalent flow) tree of a non-directed
+ * graph with n nodes, given by dense indices: the maximum flow between any
+ * two nodes is the smallest flow in the tree path between them. Node 0 is the
+ * root and every other node i hangs from parents[i] < i with flows[i].
+ *
+ * Paths are queried with binary lifting, in O(log n) per pair.
+ */
+class FlowTree {
+private:
+    std::vector<uint32_t> parents; // parent of each node, the root's is 0.
+    std::vector<double> flows; // flow between each node and its parent.
+    std::vector<uint32_t> depths; // depth of each node, the root's is 0.
+
+    /*
+     * ancestors[k][i] is the 2^k-th ancestor of i (or the root), and
+     * min_flows[k][i] is the smallest flow in the path up to it.
+     */
+    std::vector<std::vector<uint32_t>> ancestors;
+    std::vector<std::vector<double>> min_flows;
+
+    uint64_t graph_hash; // hash of the graph the tree was built for.
+
+    // buildAncestors builds depths, ancestors and min_flows from parents.
+    void buildAncestors();
+
+public:
+    /*
+     * build makes the tree with the parents and flows given (in the same
+     * format as the attributes with the same names) for a graph whose hash is
+     * graph_hash.
+     */
+    void build(const std::vector<uint32_t>& parents,
+        const std::vector<double>& flows, uint64_t graph_hash);
+
+    bool empty() const; // empty returns whether the tree was not built.
+    void clear(); // clear empties the tree.
+
+    uint64_t graphHash() const; // graphHash returns the hash the tree is for.
+
+    // minFlow returns the smallest flow in the path between nodes a and b.
+    double minFlow(uint32_t node_a, uint32_t node_b) const;
+
+    /*
+     * save writes the tree to fp, returning false if a write failed.
+     */
+    bool save(FILE* fp) const;
+
+    /*
+     * load reads a tree written by save from fp, returning false if fp does
+     * not have a valid tree for a graph with num_nodes nodes whose hash is
+     * graph_hash. The header is checked against those and against the size
+     * of the file before anything is allocated, so a truncated or corrupt
+     * file is just rejected. On failure, the tree is left empty.
+     */
+    bool load(FILE* fp, uint32_t num_nodes, uint64_t graph_hash);
+
+    FlowTree(); // Constructs an empty tree.
+};
+
+#endif
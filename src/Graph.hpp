@@ -3,9 +3,16 @@
 
 #include <cinttypes>
 #include <map>
+#include <sys/types.h>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "CSRArray.hpp"
+#include "CicleTasks.hpp"
+#include "ShortestPaths.hpp"
+#include "UnionFind.hpp"
+
 #ifndef EMPTY_VALUE
 #define EMPTY_VALUE -1
 #endif
@@ -120,6 +127,12 @@ template <class Node, class Edge> class Graph {
         std::ostream& os, const Graph<Node, Edge>& g);
 
 private:
+    /*
+     * componentIndex returns the index of node_id in components, inserting it
+     * if the node was not in any edge yet.
+     */
+    uint32_t componentIndex(int32_t node_id);
+
     /*
      * insertAdjacency inserts the Edge instance 'new_edge' in the adjancency
      * list of the Node with address new_edge.idFrom(). If the node does not
@@ -134,6 +147,12 @@ private:
      */
     void insertAdjacency(const Edge& new_edge);
 
+    /*
+     * sortEdges sorts edges by (idFrom(), idTo()) with a stable LSD radix
+     * sort, so equivalent edges keep their relative order.
+     */
+    static void sortEdges(std::vector<Edge>& edges);
+
 protected:
     /*
      * adjacencies is a map that takes the address/key of the node (as given by
@@ -149,25 +168,105 @@ protected:
     std::map<int32_t, Node> node_list;
 
     /*
-     * getNumCicles uses recursion for every edge of node_id in order to find
-     * all cicles with increasing indicies numbers (except for the last node to
-     * node_start) that start at node_start. The increasing indices order is
-     * done to have no duplicates in the final count.
+     * The graph is also stored in a compressed sparse row (CSR) layout, which
+     * is what queries traverse. Nodes get dense indices in increasing key
+     * order: csr_node_ids[i] is the key of the node with index i,
+     * csr_node_flags[i] is 0 if it is empty and 1 otherwise, and its
+     * adjacency list is csr_edges[csr_offsets[i]] up to (but not including)
+     * csr_edges[csr_offsets[i + 1]], in the same order as in adjacencies.
+     * csr_targets[j] is the dense index of the node csr_edges[j] goes to, and
+     * csr_reverse[j] is the position of the opposite edge (from csr_targets[j]
+     * back to node i), which always exists since the graph is non-directed.
+     *
+     * The maps above are the ingestion front end: freeze() rebuilds the CSR
+     * layout from them, and every insertion unfreezes the graph. The CSR
+     * arrays may also view a layout kept elsewhere (see CSRArray), in which
+     * case the maps and csr_edges stay empty until adoptCSR fills them.
+     */
+    CSRArray<int32_t> csr_node_ids;
+    CSRArray<uint8_t> csr_node_flags;
+    CSRArray<uint32_t> csr_offsets;
+    std::vector<Edge> csr_edges;
+    CSRArray<uint32_t> csr_targets;
+    CSRArray<uint32_t> csr_reverse;
+    bool frozen = false; // whether the CSR layout is up to date.
+
+    /*
+     * csr_version is incremented every time the CSR layout is rebuilt, so
+     * data derived from it can tell when it is outdated.
+     */
+    uint64_t csr_version = 0;
+
+    /*
+     * components joins the ends of every edge as it is inserted, so the
+     * connected components are always known without a search. Since dense
+     * indices only exist after freeze(), it works over component_indices,
+     * given to node keys the first time they are in an edge. freeze() turns
+     * it into csr_components: csr_components[i] is the smallest dense index
+     * in the component of the node with dense index i.
+     */
+    UnionFind components;
+    std::unordered_map<int32_t, uint32_t> component_indices;
+    CSRArray<uint32_t> csr_components;
+
+    /*
+     * shortest_paths is the engine reused by every shortest path query, so
+     * their setup does not grow with the graph.
+     */
+    ShortestPaths shortest_paths;
+
+    /*
+     * adoptCSR fills adjacencies and components from a CSR layout (csr_edges
+     * and csr_components included) that was not built by freeze(), e.g. read
+     * from a file, and makes the graph frozen with it. node_list must already
+     * have a node for every key in csr_node_ids.
+     */
+    void adoptCSR();
+
+    /*
+     * denseIndex returns the dense index of the node with key node_id, or
+     * EMPTY_VALUE if there is no such node, by binary search in the sorted
+     * csr_node_ids. The graph must be frozen.
+     */
+    ssize_t denseIndex(int32_t node_id) const;
+
+    /*
+     * hasConnections returns whether node_index is a valid dense index (not
+     * EMPTY_VALUE) of a node with at least one edge. The graph must be frozen.
+     */
+    bool hasConnections(ssize_t node_index) const;
+
+    /*
+     * sameComponent returns whether the nodes with dense indices a and b (not
+     * EMPTY_VALUE) are connected by some path. The graph must be frozen.
      */
-    int32_t getNumCicles(Node& node_start, int32_t node_id);
+    bool sameComponent(uint32_t node_a, uint32_t node_b) const;
 
     /*
-     * getLen uses a map of marked nodes in the current path, maximim plausable
-     * len (a result we already have) and a minimum possible len (the current
-     * lenght in the current path up to now) to calculate the minimum distance
-     * between a starting node and an ending node. This algorithm is made by
-     * the creators of the program, and is based on a similar method used in
-     * the discrete version of the simplex method: the branch-and-bound
-     * algorithm.
+     * getNumCicles walks every path in stack in order to find all cicles with
+     * increasing indicies numbers (except for the last node to start_index)
+     * that start at start_index. The increasing indices order is done to have
+     * no duplicates in the final count. Indices are dense, which are ordered
+     * in the same way as node keys.
+     *
+     * The paths are walked depth first with an explicit stack of nodes, each
+     * with the next of its edges to walk, so long paths can't overflow the
+     * call stack. Each edge walked takes one unit of budget. If it runs out,
+     * the walk stops with the rest of it left in stack, so that it can be
+     * resumed with more budget, and only the cicles found until then are
+     * counted.
+     */
+    int32_t getNumCicles(uint32_t start_index, uint64_t& budget,
+        std::vector<std::pair<uint32_t, uint32_t>>& stack) const;
+
+    /*
+     * countCicleTasks runs the tasks of thread in a parallel cicle count,
+     * adding the cicles found to cicles. Tasks less than split_depth edges
+     * deep are split in one task per edge, the others are walked by the
+     * private getNumCicles.
      */
-    int32_t getLen(std::map<int32_t, bool>& marks, int32_t node_start_id,
-        int32_t node_end_id, int32_t max_plausable_len,
-        int32_t min_possible_len);
+    void countCicleTasks(CicleTasks& tasks, uint32_t thread,
+        uint32_t split_depth, int64_t& cicles) const;
 
 public:
     /*
@@ -193,6 +292,43 @@ public:
      */
     void insertEdge(Edge& new_edge);
 
+    /*
+     * insertEdges inserts all new_edges in the graph at once, with the same
+     * result as calling insertEdge for each one of them in order: both
+     * directions of every edge are inserted, adjacency lists stay ordered by
+     * operator<(Edge, Edge) and, between equivalent edges, the one inserted
+     * first is kept. Instead of one ordered insertion per edge, all edges are
+     * radix sorted and deduplicated in one pass, and then merged into the
+     * adjacency lists. If any edge is invalid, it throws a runtime_error()
+     * exception before inserting anything.
+     */
+    void insertEdges(const std::vector<Edge>& new_edges);
+
+    /*
+     * freeze builds the CSR layout from the adjacency maps, if they changed
+     * since the last call. Queries call it themselves, but their const
+     * versions, which can run in parallel, need it to be called first.
+     */
+    void freeze();
+
+    // getNumNodes returns the number of nodes in the graph, empty ones too.
+    size_t getNumNodes() const;
+
+    /*
+     * getComponent returns the id of the connected component of the node
+     * with key node_id, which is the smallest key in the component, or
+     * EMPTY_VALUE if there is no such node.
+     */
+    ssize_t getComponent(int32_t node_id);
+
+    /*
+     * The const overloads of getComponent, getNumCicles and
+     * getCyclomaticNumber do the same as their non-const versions, but the
+     * graph must already be frozen. They change nothing in the graph, so any
+     * number of threads may call them at the same time.
+     */
+    ssize_t getComponent(int32_t node_id) const;
+
     /*
      * getNumCicles calculates all cicles in a graph. This is done by calling,
      * for every node in the graph, the private overload of getNumCicles for
@@ -202,11 +338,48 @@ public:
     int32_t getNumCicles(void);
 
     /*
-     * getLen calculates the minimum distance between nodes a and b.
-     * The method initializes a map to keep track of recursions and calls the
-     * private version of getLen().
+     * getNumCicles counts cicles in the same way, but walking at most budget
+     * edges, which bounds its time. If the budget runs out, truncated is set
+     * and only the cicles found until then are counted, otherwise the count
+     * is exact.
+     */
+    int32_t getNumCicles(uint64_t budget, bool& truncated);
+
+    /*
+     * getNumCicles counts cicles in the same way, but with num_threads
+     * threads. The paths from each node are split in tasks at split_depth
+     * edges from it, which the threads share by work stealing (see
+     * CicleTasks), and each thread keeps its own count, all added at the end.
+     * The budget is shared by all threads, and if it does not run out, the
+     * count is the same as the sequential one.
+     */
+    int32_t getNumCicles(uint32_t num_threads, uint32_t split_depth,
+        uint64_t budget, bool& truncated);
+    int32_t getNumCicles(uint32_t num_threads, uint32_t split_depth,
+        uint64_t budget, bool& truncated) const;
+
+    /*
+     * getCyclomaticNumber returns the number of independent cicles of the
+     * graph, E - V + C for E edges (each pair of directions counted once), V
+     * nodes and C connected components. It runs in linear time, but counts
+     * only a basis of the cicles, unlike getNumCicles, so the numbers differ.
+     */
+    int32_t getCyclomaticNumber(void);
+    int32_t getCyclomaticNumber(void) const;
+
+    /*
+     * getLen calculates the minimum distance between nodes a and b, using
+     * the lengths given by the edges' c_speed, or -1 if there is no path (a
+     * node is never considered to have a path to itself). It runs Dijkstra's
+     * algorithm, see ShortestPaths.
      */
     int32_t getLen(int32_t node_a_id, int32_t node_b_id);
+
+    /*
+     * setShortestPathHeap chooses the priority queue used by shortest path
+     * queries, see ShortestPathHeap. The default is an automatic_heap.
+     */
+    void setShortestPathHeap(ShortestPathHeap heap_type);
 };
 
 #endif
\ No newline at end of file
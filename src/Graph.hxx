@@ -1,33 +1,34 @@
 #ifndef __GRAPH_HXX__
 #define __GRAPH_HXX__
 
+#include <algorithm>
 #include <cinttypes>
 #include <iostream>
+#include <limits>
 #include <queue>
 #include <stdexcept>
+#include <thread>
 
+#include "CSRArray.hxx"
 #include "Graph.hpp"
+#include "ShortestPaths.hxx"
+#include "Stats.hpp"
+#include "Trace.hpp"
 
 template <class Node, class Edge>
 std::ostream& operator<<(std::ostream& os, const Graph<Node, Edge>& graph) {
-    for (auto node_it = graph.node_list.begin();
-         node_it != graph.node_list.end(); node_it++) {
-
-        if (node_it->second.isEmpty()) {
+    for (auto& node : graph.node_list) {
+        if (node.second.isEmpty()) {
             continue; // Do not print empty nodes.
         }
 
-        std::vector<Edge> connections;
-
-        try {
-            connections = graph.adjacencies.at(node_it->second.idKey());
-        } catch (std::out_of_range& e) {
+        auto adjacency_it = graph.adjacencies.find(node.first);
+        if (adjacency_it == graph.adjacencies.end()) {
             continue;
         }
 
-        for (auto edge_it = connections.begin(); edge_it != connections.end();
-             edge_it++) {
-            os << (*node_it).second << " " << *edge_it << std::endl;
+        for (const Edge& edge : adjacency_it->second) {
+            os << node.second << " " << edge << "\n";
         }
     }
 
@@ -44,6 +45,9 @@ void Graph<Node, Edge>::insertEdge(Edge& new_edge) {
                                  "POP's ID. It must be a valid address.");
     }
 
+    frozen = false;
+    components.merge(
+        componentIndex(new_edge.idFrom()), componentIndex(new_edge.idTo()));
     insertAdjacency(new_edge);
     
     /*
@@ -66,13 +70,140 @@ void Graph<Node, Edge>::insertEdge(Edge& new_edge) {
     node_list.insert(std::pair<int32_t, Node>(new_edge.idTo(), Node()));
 }
 
+template <class Node, class Edge>
+void Graph<Node, Edge>::insertEdges(const std::vector<Edge>& new_edges) {
+    for (auto& new_edge : new_edges) {
+        if (new_edge.idFrom() == EMPTY_VALUE) {
+            throw std::runtime_error(
+                "Cannot insert Edge with invalid idConnect.");
+
+        } else if (new_edge.idTo() == EMPTY_VALUE) {
+            throw std::runtime_error("Cannot insert Edge with invalid "
+                                     "Connected POP's ID. It must be a valid "
+                                     "address.");
+        }
+    }
+
+    frozen = false;
+    TraceScope trace("insert_edges", "connections", new_edges.size());
+
+    // emit both directions in the same order insertEdge would insert them
+    std::vector<Edge> edges;
+    edges.reserve(2 * new_edges.size());
+    for (auto& new_edge : new_edges) {
+        components.merge(componentIndex(new_edge.idFrom()),
+            componentIndex(new_edge.idTo()));
+
+        edges.push_back(new_edge);
+        edges.push_back(new_edge);
+        edges.back().reverse();
+    }
+
+    sortEdges(edges);
+    uint64_t duplicates = 0;
+
+    for (size_t start = 0; start < edges.size();) {
+        // all edges from the same node are contiguous and ordered by idTo
+        int32_t node_id = edges[start].idFrom();
+        std::vector<Edge> unique_edges;
+        size_t end = start;
+
+        for (; end < edges.size() && edges[end].idFrom() == node_id; end++) {
+            // the first of equivalent edges is the one kept
+            if (unique_edges.size() == 0
+                || !(unique_edges.back() == edges[end])) {
+                unique_edges.push_back(edges[end]);
+            } else {
+                duplicates++;
+            }
+        }
+        start = end;
+
+        // every end of an edge is also an idFrom, so this inserts the empty
+        // nodes for all of them (see insertEdge)
+        node_list.emplace_hint(node_list.end(), node_id, Node());
+
+        std::vector<Edge>& adjacent_nodes = adjacencies[node_id];
+        if (adjacent_nodes.size() == 0) {
+            adjacent_nodes = std::move(unique_edges);
+            continue;
+        }
+
+        // merge with the existing list, whose edges were inserted first
+        std::vector<Edge> merged;
+        merged.reserve(adjacent_nodes.size() + unique_edges.size());
+        auto old_it = adjacent_nodes.begin();
+        auto new_it = unique_edges.begin();
+
+        while (old_it != adjacent_nodes.end() || new_it != unique_edges.end()) {
+            if (new_it == unique_edges.end()
+                || (old_it != adjacent_nodes.end() && *old_it < *new_it)) {
+                merged.push_back(*old_it++);
+            } else if (old_it == adjacent_nodes.end() || *new_it < *old_it) {
+                merged.push_back(*new_it++);
+            } else {
+                merged.push_back(*old_it++); // equivalent, keep the old one.
+                new_it++;
+                duplicates++;
+            }
+        }
+
+        adjacent_nodes = std::move(merged);
+    }
+
+    Stats::add(stat_edges_deduplicated, duplicates);
+}
+
+template <class Node, class Edge>
+void Graph<Node, Edge>::sortEdges(std::vector<Edge>& edges) {
+    // keys are (idFrom, idTo) with the sign bits flipped, so that unsigned
+    // order is the same as signed order
+    std::vector<std::pair<uint64_t, uint32_t>> keys(edges.size());
+    for (size_t i = 0; i < edges.size(); i++) {
+        uint64_t from = (uint32_t)edges[i].idFrom() ^ 0x80000000u;
+        uint64_t to = (uint32_t)edges[i].idTo() ^ 0x80000000u;
+        keys[i] = std::make_pair(from << 32 | to, (uint32_t)i);
+    }
+
+    // one counting sort pass for each byte, from the least significant one
+    std::vector<std::pair<uint64_t, uint32_t>> sorted_keys(keys.size());
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        size_t counts[257] = { 0 };
+        for (auto& key : keys) {
+            counts[((key.first >> shift) & 0xff) + 1]++;
+        }
+
+        // skip bytes that are the same for every key, common for small ids
+        if (keys.size() == 0
+            || counts[((keys[0].first >> shift) & 0xff) + 1] == keys.size()) {
+            continue;
+        }
+
+        for (uint32_t digit = 1; digit <= 256; digit++) {
+            counts[digit] += counts[digit - 1];
+        }
+        for (auto& key : keys) {
+            sorted_keys[counts[(key.first >> shift) & 0xff]++] = key;
+        }
+        keys.swap(sorted_keys);
+    }
+
+    std::vector<Edge> sorted_edges;
+    sorted_edges.reserve(edges.size());
+    for (auto& key : keys) {
+        sorted_edges.push_back(edges[key.second]);
+    }
+    edges.swap(sorted_edges);
+}
+
 template <class Node, class Edge>
 void Graph<Node, Edge>::insertAdjacency(const Edge& new_edge) {
     std::vector<Edge>& adjacent_nodes = adjacencies[new_edge.idFrom()];
 
     if (adjacent_nodes.size() == 0) { // If adjacency list is empty, insert
         adjacent_nodes.push_back(new_edge); // new_node directly. Binary search
-    } // does not work in empty vectors.
+        return; // does not work in empty vectors.
+    }
 
     // Initialize binary search parameters.
     ssize_t start = 0;
@@ -82,7 +213,9 @@ void Graph<Node, Edge>::insertAdjacency(const Edge& new_edge) {
         ssize_t middle = (start + end) / 2;
 
         if (adjacent_nodes[middle] == new_edge) {
-            return; // Equivalent edge already exists, so do nothing.
+            // Equivalent edge already exists, so do nothing.
+            Stats::add(stat_edges_deduplicated, 1);
+            return;
 
         } else if ((adjacent_nodes[middle] < new_edge) && (end > start)) {
             start = middle + 1; // edge is in the upper half of current
@@ -111,6 +244,8 @@ void Graph<Node, Edge>::insertNode(const Node& new_node) {
         throw std::runtime_error("Cannot insert Node with empty idConnect");
     }
 
+    frozen = false;
+
     // Insert only if the node does not exist.
     auto result = node_list.insert(
         std::pair<int32_t, Node>(new_node.idKey(), new_node));
@@ -121,133 +256,409 @@ void Graph<Node, Edge>::insertNode(const Node& new_node) {
     }
 }
 
+template <class Node, class Edge> void Graph<Node, Edge>::freeze() {
+    if (frozen) {
+        return;
+    }
+
+    TraceScope trace("freeze", "nodes", node_list.size());
+
+    // node keys are already sorted in node_list, so they are the dense ids
+    std::vector<int32_t> node_ids;
+    std::vector<uint8_t> node_flags;
+    node_ids.reserve(node_list.size());
+    node_flags.reserve(node_list.size());
+    for (auto& node : node_list) {
+        node_ids.push_back(node.first);
+        node_flags.push_back(node.second.isEmpty() ? 0 : 1);
+    }
+    csr_node_ids.assign(std::move(node_ids));
+    csr_node_flags.assign(std::move(node_flags));
+
+    std::vector<uint32_t> offsets(1, 0);
+    offsets.reserve(csr_node_ids.size() + 1);
+    csr_edges.clear();
+
+    for (int32_t node_id : csr_node_ids) {
+        auto adjacency_it = adjacencies.find(node_id);
+        if (adjacency_it != adjacencies.end()) {
+            for (auto& edge : adjacency_it->second) {
+                csr_edges.push_back(edge);
+            }
+        }
+
+        offsets.push_back(csr_edges.size());
+    }
+    csr_offsets.assign(std::move(offsets));
+
+    // every edge end has a node in node_list, see insertEdge
+    std::vector<uint32_t> targets;
+    targets.reserve(csr_edges.size());
+    for (auto& edge : csr_edges) {
+        targets.push_back(denseIndex(edge.idTo()));
+    }
+
+    // adjacency lists are ordered by target, so binary search the opposite
+    std::vector<uint32_t> reverse(csr_edges.size());
+    for (uint32_t node = 0; node < csr_node_ids.size(); node++) {
+        for (uint32_t edge = csr_offsets[node]; edge < csr_offsets[node + 1];
+             edge++) {
+            uint32_t target = targets[edge];
+            auto reverse_it
+                = std::lower_bound(targets.begin() + csr_offsets[target],
+                    targets.begin() + csr_offsets[target + 1], node);
+            reverse[edge] = reverse_it - targets.begin();
+        }
+    }
+    csr_targets.assign(std::move(targets));
+    csr_reverse.assign(std::move(reverse));
+
+    // name each component after its first node in dense order
+    std::vector<uint32_t> first_nodes(component_indices.size(), UINT32_MAX);
+    std::vector<uint32_t> node_components(csr_node_ids.size());
+    for (uint32_t node = 0; node < csr_node_ids.size(); node++) {
+        auto component_it = component_indices.find(csr_node_ids[node]);
+        if (component_it == component_indices.end()) {
+            node_components[node] = node; // a node without edges is alone.
+            continue;
+        }
+
+        uint32_t root = components.find(component_it->second);
+        if (first_nodes[root] == UINT32_MAX) {
+            first_nodes[root] = node;
+        }
+        node_components[node] = first_nodes[root];
+    }
+    csr_components.assign(std::move(node_components));
+
+    csr_version++;
+    frozen = true;
+}
+
+template <class Node, class Edge> void Graph<Node, Edge>::adoptCSR() {
+    adjacencies.clear();
+    component_indices.clear();
+    components.reset(0);
+
+    // node keys are sorted, so every adjacency list goes at the end
+    for (uint32_t node = 0; node < csr_node_ids.size(); node++) {
+        int32_t node_id = csr_node_ids[node];
+
+        if (csr_offsets[node] == csr_offsets[node + 1]) {
+            continue; // nodes without edges have no adjacency list.
+        }
+
+        adjacencies.emplace_hint(adjacencies.end(), node_id,
+            std::vector<Edge>(csr_edges.begin() + csr_offsets[node],
+                csr_edges.begin() + csr_offsets[node + 1]));
+
+        // join each node with the first one of its component
+        components.merge(componentIndex(csr_node_ids[csr_components[node]]),
+            componentIndex(node_id));
+    }
+
+    csr_version++;
+    frozen = true;
+}
+
+template <class Node, class Edge>
+ssize_t Graph<Node, Edge>::denseIndex(int32_t node_id) const {
+    auto index_it
+        = std::lower_bound(csr_node_ids.begin(), csr_node_ids.end(), node_id);
+    if (index_it == csr_node_ids.end() || *index_it != node_id) {
+        return EMPTY_VALUE;
+    }
+
+    return index_it - csr_node_ids.begin();
+}
+
+template <class Node, class Edge>
+size_t Graph<Node, Edge>::getNumNodes() const {
+    // the maps are empty while the CSR arrays view a layout kept elsewhere
+    return frozen ? csr_node_ids.size() : node_list.size();
+}
+
+template <class Node, class Edge>
+ssize_t Graph<Node, Edge>::getComponent(int32_t node_id) {
+    freeze();
+    return static_cast<const Graph&>(*this).getComponent(node_id);
+}
+
+template <class Node, class Edge>
+ssize_t Graph<Node, Edge>::getComponent(int32_t node_id) const {
+    ssize_t node = denseIndex(node_id);
+    if (node == EMPTY_VALUE) {
+        return EMPTY_VALUE;
+    }
+
+    return csr_node_ids[csr_components[node]];
+}
+
+template <class Node, class Edge>
+uint32_t Graph<Node, Edge>::componentIndex(int32_t node_id) {
+    auto index_it = component_indices.find(node_id);
+    if (index_it != component_indices.end()) {
+        return index_it->second;
+    }
+
+    uint32_t index = components.insert();
+    component_indices.emplace(node_id, index);
+    return index;
+}
+
+template <class Node, class Edge>
+bool Graph<Node, Edge>::hasConnections(ssize_t node_index) const {
+    return node_index != EMPTY_VALUE
+        && csr_offsets[node_index] != csr_offsets[node_index + 1];
+}
+
+template <class Node, class Edge>
+bool Graph<Node, Edge>::sameComponent(uint32_t node_a, uint32_t node_b) const {
+    return csr_components[node_a] == csr_components[node_b];
+}
+
 template <class Node, class Edge>
 int32_t Graph<Node, Edge>::getNumCicles(void) {
-    if (node_list.size() == 0) {
+    bool truncated;
+    return getNumCicles(UINT64_MAX, truncated);
+}
+
+template <class Node, class Edge>
+int32_t Graph<Node, Edge>::getNumCicles(uint64_t budget, bool& truncated) {
+    freeze();
+    truncated = false;
+    if (csr_node_ids.size() == 0) {
         // if the graph is empty, there are no cicles.
         return 0;
     }
 
     int32_t cicles = 0;
-    for (auto node : node_list) {
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    for (uint32_t node = 0; node < csr_node_ids.size(); node++) {
         // for every node, calculate the number of cicles starting from it.
         // because of the increasing indices property, no duplicates are
-        // counted.
-        cicles += getNumCicles(node.second, node.first);
-
-        for (auto edge : adjacencies[node.first]) {
+        // counted. Empty nodes have no valid key, so no path ever gets back
+        // to them.
+        uint32_t start = csr_node_flags[node] == 0 ? UINT32_MAX : node;
+        stack.assign(1, std::make_pair(node, csr_offsets[node]));
+        cicles += getNumCicles(start, budget, stack);
+
+        for (uint32_t edge = csr_offsets[node]; edge < csr_offsets[node + 1];
+             edge++) {
             /*
              * some extra connections (those that go from the first node back to
              * it) should not count as cicles, so remove them
              */
-            if (node.first < edge.idTo()) {
+            if (node < csr_targets[edge]) {
                 cicles--;
             }
         }
+
+        if (!stack.empty()) {
+            // the walk was interrupted, so the count is not complete
+            truncated = true;
+            break;
+        }
     }
 
     return cicles;
 }
 
 template <class Node, class Edge>
-int32_t Graph<Node, Edge>::getNumCicles(Node& node_start, int32_t node_id) {
+int32_t Graph<Node, Edge>::getNumCicles(uint32_t num_threads,
+    uint32_t split_depth, uint64_t budget, bool& truncated) {
+
+    freeze();
+    return static_cast<const Graph&>(*this).getNumCicles(
+        num_threads, split_depth, budget, truncated);
+}
+
+template <class Node, class Edge>
+int32_t Graph<Node, Edge>::getNumCicles(uint32_t num_threads,
+    uint32_t split_depth, uint64_t budget, bool& truncated) const {
+
+    num_threads = std::max<uint32_t>(1, num_threads);
+
+    // the paths from each node start as a task, spread over all threads
+    CicleTasks tasks(num_threads, budget);
+    int64_t cicles = 0;
+    for (uint32_t node = 0; node < csr_node_ids.size(); node++) {
+        // empty nodes never close a cicle, as in the sequential count
+        uint32_t start = csr_node_flags[node] == 0 ? UINT32_MAX : node;
+        tasks.push(node % num_threads, CicleTask { start, node, 0 });
+
+        // the connections that span only two nodes are removed here
+        for (uint32_t edge = csr_offsets[node]; edge < csr_offsets[node + 1];
+             edge++) {
+            if (node < csr_targets[edge]) {
+                cicles--;
+            }
+        }
+    }
+
+    std::vector<int64_t> thread_cicles(num_threads, 0);
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 1; thread < num_threads; thread++) {
+        threads.push_back(std::thread(&Graph::countCicleTasks, this,
+            std::ref(tasks), thread, split_depth,
+            std::ref(thread_cicles[thread])));
+    }
+
+    // the current thread works as the first one
+    countCicleTasks(tasks, 0, split_depth, thread_cicles[0]);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int64_t count : thread_cicles) {
+        cicles += count;
+    }
+
+    truncated = tasks.isStopped();
+    return cicles;
+}
+
+template <class Node, class Edge>
+void Graph<Node, Edge>::countCicleTasks(CicleTasks& tasks, uint32_t thread,
+    uint32_t split_depth, int64_t& cicles) const {
+
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    uint64_t budget = 0;
+    CicleTask task;
+
+    while (tasks.pop(thread, task)) {
+        uint32_t node = task.node_index;
+
+        if (task.depth < split_depth) {
+            // a new task for every edge the path can go through
+            for (uint32_t edge = csr_offsets[node];
+                 edge < csr_offsets[node + 1]; edge++) {
+                if (budget == 0 && !tasks.takeBudget(budget)) {
+                    break;
+                }
+                budget--;
+
+                uint32_t target = csr_targets[edge];
+                if (target == task.start_index) {
+                    cicles++;
+                } else if (target >= node) {
+                    tasks.push(thread,
+                        CicleTask { task.start_index, target, task.depth + 1 });
+                }
+            }
+        } else {
+            // deep enough, walk all paths from here in this thread
+            stack.assign(1, std::make_pair(node, csr_offsets[node]));
+            cicles += getNumCicles(task.start_index, budget, stack);
+
+            while (!stack.empty() && tasks.takeBudget(budget)) {
+                cicles += getNumCicles(task.start_index, budget, stack);
+            }
+        }
+
+        tasks.finish();
+    }
+}
+
+template <class Node, class Edge>
+int32_t Graph<Node, Edge>::getNumCicles(uint32_t start_index, uint64_t& budget,
+    std::vector<std::pair<uint32_t, uint32_t>>& stack) const {
+
     int32_t cicles = 0;
-    for (auto edge : adjacencies[node_id]) {
+    while (!stack.empty()) {
+        uint32_t node = stack.back().first;
+        uint32_t edge = stack.back().second;
+        if (edge == csr_offsets[node + 1]) {
+            stack.pop_back(); // every connection was walked, go back.
+            continue;
+        }
+
+        if (budget == 0) {
+            return cicles; // the rest of the walk is left in the stack.
+        }
+        budget--;
+
         // for every connection
+        stack.back().second++;
+        uint32_t target = csr_targets[edge];
 
-        if (edge.idTo() == node_start.idKey()) {
+        if (target == start_index) {
             // if the connection is the starting node, this is a cicle!
             // no need to consider the increase in index, this is the only case
             // that this can be ignored.
             cicles++;
             continue;
         }
-        if (edge.idTo() < node_id) {
-            // to remove duplates, only recurse in increasing indices.
+        if (target < node) {
+            // to remove duplates, only walk in increasing indices.
             continue;
         }
 
-        // recurse inside the edge with the same starting node
-        cicles += getNumCicles(node_start, edge.idTo());
+        // walk the edge with the same starting node
+        stack.push_back(std::make_pair(target, csr_offsets[target]));
     }
 
     return cicles;
 }
 
 template <class Node, class Edge>
-int32_t Graph<Node, Edge>::getLen(std::map<int32_t, bool>& marks,
-    int32_t node_start_id, int32_t node_end_id, int32_t max_plausable_len,
-    int32_t min_possible_len) {
-
-    if (min_possible_len >= max_plausable_len) {
-        /*
-         * if we already have a solution (max_plausable_len) that has a smaller
-         * distance than what we can ever hope to achieve in this recursion
-         * (min_possible_len), we can just ignore this recursion: even if we get
-         * a solution it will be worst than what we already have
-         */
-        return max_plausable_len;
-    }
+int32_t Graph<Node, Edge>::getCyclomaticNumber(void) {
+    freeze();
+    return static_cast<const Graph&>(*this).getCyclomaticNumber();
+}
 
-    // for all connections in our starting node
-    for (auto connection : adjacencies[node_start_id]) {
-        // if the connected node is marked, return: we have already gone there
-        if (marks[connection.idTo()]) {
-            continue;
-        }
-        // if the connected node is our destiny
-        if (connection.idTo() == node_end_id) {
-            // get the better solution: what we already have or the new solution
-            max_plausable_len = std::min(
-                max_plausable_len, connection.c_speed + min_possible_len);
-            continue;
+template <class Node, class Edge>
+int32_t Graph<Node, Edge>::getCyclomaticNumber(void) const {
+    // count every connection once, and every component at its first node
+    int64_t num_edges = 0;
+    int64_t num_components = 0;
+    for (uint32_t node = 0; node < csr_node_ids.size(); node++) {
+        for (uint32_t edge = csr_offsets[node]; edge < csr_offsets[node + 1];
+             edge++) {
+            if (node < csr_targets[edge]) {
+                num_edges++;
+            }
         }
 
-        // if the connected node is not marked and not the ending node
-        // mark it, we will go there now
-        marks[connection.idTo()] = true;
-
-        // recusion: start at the connected node with a new min_possible_len
-        // to include the distance from the current node to the connected one
-        max_plausable_len = getLen(marks, connection.idTo(), node_end_id,
-            max_plausable_len, min_possible_len + connection.c_speed);
-
-        // unmark the node: other paths might use it
-        marks[connection.idTo()] = false;
+        if (csr_components[node] == node) {
+            num_components++;
+        }
     }
 
-    // return our best solution yet
-    return max_plausable_len;
+    return num_edges - (int64_t)csr_node_ids.size() + num_components;
 }
 
 template <class Node, class Edge>
 int32_t Graph<Node, Edge>::getLen(int32_t node_a_id, int32_t node_b_id) {
-    try {
-        // if the origin or destination nodes do not exist, no path exists
-        adjacencies.at(node_a_id);
-        adjacencies.at(node_b_id);
-    } catch (std::out_of_range& e) {
+    freeze();
+
+    // if the origin or destination nodes do not exist, no path exists
+    ssize_t node_a = denseIndex(node_a_id);
+    ssize_t node_b = denseIndex(node_b_id);
+    if (!hasConnections(node_a) || !hasConnections(node_b)) {
         return -1;
     }
 
-    // all marked nodes, keeps track of recursion to prohibit infinite loops
-    std::map<int32_t, bool> marks {};
-
-    for (auto node : node_list) {
-        // initialize all nodes as unmarked
-        marks[node.first] = false;
+    // a path can't go back to where it started, nor leave its component
+    if (node_a == node_b || !sameComponent(node_a, node_b)) {
+        return -1;
     }
 
-    // initialize the recursive version, starting with the first node
-    marks[node_a_id] = true;
-    int32_t ret = getLen(marks, node_a_id, node_b_id, INT32_MAX, 0);
-    marks[node_a_id] = false;
+    shortest_paths.run(csr_offsets, csr_targets, csr_edges,
+        [](const Edge& edge) { return edge.c_speed; }, node_a, node_b);
 
-    if (ret == INT32_MAX) {
+    double len = shortest_paths.distance(node_b);
+    if (len == std::numeric_limits<double>::infinity()) {
         return -1;
     }
 
-    return ret;
+    return len;
+}
+
+template <class Node, class Edge>
+void Graph<Node, Edge>::setShortestPathHeap(ShortestPathHeap heap_type) {
+    shortest_paths.setHeapType(heap_type);
 }
 
 #endif
\ No newline at end of file
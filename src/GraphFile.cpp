@@ -0,0 +1,273 @@
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "GraphFile.hpp"
+#include "Trace.hpp"
+
+// the number of sections after the header, see GraphFile's attributes.
+#define GRAPH_FILE_SECTIONS 9
+
+// the suffix of the file a graph file is written to before being renamed.
+#define GRAPH_FILE_TEMPORARY ".tmp"
+
+/*
+ * alignUp returns the first multiple of GRAPH_FILE_ALIGNMENT that is not
+ * smaller than size.
+ */
+static size_t alignUp(size_t size) {
+    return (size + GRAPH_FILE_ALIGNMENT - 1) / GRAPH_FILE_ALIGNMENT
+        * GRAPH_FILE_ALIGNMENT;
+}
+
+size_t GraphFile::layout(
+    const graphFileHeader& header, size_t* starts, size_t* sizes) {
+
+    size_t nodes = header.num_nodes;
+    size_t edges = header.num_edges;
+    sizes[0] = nodes * sizeof(int32_t); // node_ids
+    sizes[1] = nodes * sizeof(uint8_t); // node_flags
+    sizes[2] = (nodes + 1) * sizeof(uint32_t); // offsets
+    sizes[3] = edges * sizeof(uint32_t); // targets
+    sizes[4] = edges * sizeof(uint32_t); // reverse
+    sizes[5] = edges * sizeof(double); // speeds
+    sizes[6] = nodes * sizeof(uint32_t); // components
+    sizes[7] = (nodes * GRAPH_FILE_STRINGS_PER_NODE + 1) * sizeof(uint32_t);
+    sizes[8] = header.strings_size; // strings
+
+    size_t position = alignUp(sizeof(graphFileHeader));
+    for (size_t section = 0; section < GRAPH_FILE_SECTIONS; section++) {
+        starts[section] = position;
+        position = alignUp(position + sizes[section]);
+    }
+
+    return position;
+}
+
+bool GraphFile::isValid() const {
+    uint32_t nodes = header->num_nodes;
+    uint32_t edges = header->num_edges;
+
+    // every node's edges are after the previous node's, and inside the file
+    if (offsets[0] != 0 || offsets[nodes] != edges) {
+        return false;
+    }
+    for (uint32_t node = 0; node < nodes; node++) {
+        if (offsets[node] > offsets[node + 1] || components[node] >= nodes) {
+            return false;
+        }
+    }
+
+    for (uint32_t edge = 0; edge < edges; edge++) {
+        if (targets[edge] >= nodes || reverse[edge] >= edges) {
+            return false;
+        }
+    }
+
+    // node keys are the dense ids, so they must be sorted and unique
+    for (uint32_t node = 1; node < nodes; node++) {
+        if (node_ids[node - 1] >= node_ids[node]) {
+            return false;
+        }
+    }
+
+    // the same for every string, and every acronym has the same size
+    size_t num_strings = (size_t)nodes * GRAPH_FILE_STRINGS_PER_NODE;
+    if (string_offsets[0] != 0
+        || string_offsets[num_strings] != header->strings_size) {
+        return false;
+    }
+    for (size_t string = 0; string < num_strings; string++) {
+        if (string_offsets[string] > string_offsets[string + 1]
+            || (string % GRAPH_FILE_STRINGS_PER_NODE == 0
+                && string_offsets[string + 1] - string_offsets[string]
+                    != ACRONYM_SIZE)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void GraphFile::close() {
+    if (mapping != NULL) {
+        munmap((void*)mapping, mapping_size);
+    }
+
+    mapping = NULL;
+    mapping_size = 0;
+    header = NULL;
+}
+
+bool GraphFile::open(const char* file_name) {
+    TraceScope trace("graph_file_open");
+    close();
+
+    int fd = ::open(file_name, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1
+        || (size_t)file_stat.st_size < sizeof(graphFileHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* address
+        = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping stays valid without the descriptor.
+    if (address == MAP_FAILED) {
+        return false;
+    }
+
+    mapping = (const char*)address;
+    mapping_size = file_stat.st_size;
+    header = (const graphFileHeader*)mapping;
+
+    size_t starts[GRAPH_FILE_SECTIONS];
+    size_t sizes[GRAPH_FILE_SECTIONS];
+    if (std::memcmp(header->magic, GRAPH_FILE_MAGIC, GRAPH_FILE_MAGIC_SIZE) != 0
+        || layout(*header, starts, sizes) != mapping_size) {
+        close();
+        return false;
+    }
+
+    node_ids = (const int32_t*)(mapping + starts[0]);
+    node_flags = (const uint8_t*)(mapping + starts[1]);
+    offsets = (const uint32_t*)(mapping + starts[2]);
+    targets = (const uint32_t*)(mapping + starts[3]);
+    reverse = (const uint32_t*)(mapping + starts[4]);
+    speeds = (const double*)(mapping + starts[5]);
+    components = (const uint32_t*)(mapping + starts[6]);
+    string_offsets = (const uint32_t*)(mapping + starts[7]);
+    strings = mapping + starts[8];
+
+    // only the ends of the offsets are checked here, see isValid
+    size_t num_strings
+        = (size_t)header->num_nodes * GRAPH_FILE_STRINGS_PER_NODE;
+    if (offsets[0] != 0 || offsets[header->num_nodes] != header->num_edges
+        || string_offsets[0] != 0
+        || string_offsets[num_strings] != header->strings_size) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool GraphFile::isFresh(const Table& table, bool verify) const {
+    uint64_t table_size;
+    int64_t table_modified;
+    if (mapping == NULL || !table.getFileStat(table_size, table_modified)) {
+        return false;
+    }
+
+    if (header->next_rrn != table.getNextRRN()
+        || header->entries_removed != table.getEntriesRemoved()
+        || header->times_compacted != table.getTimesCompacted()
+        || header->table_size != table_size
+        || header->table_modified != table_modified) {
+        return false;
+    }
+
+    return !verify || header->table_hash == table.contentHash();
+}
+
+bool GraphFile::write(
+    const char* file_name, const Table& table, const GraphFileData& data) {
+
+    TraceScope trace("graph_file_write", "nodes", data.node_ids.size());
+    graphFileHeader header = {};
+    std::memcpy(header.magic, GRAPH_FILE_MAGIC, GRAPH_FILE_MAGIC_SIZE);
+    header.num_nodes = data.node_ids.size();
+    header.num_edges = data.targets.size();
+    header.next_rrn = table.getNextRRN();
+    header.entries_removed = table.getEntriesRemoved();
+    header.times_compacted = table.getTimesCompacted();
+    header.strings_size = data.strings.size();
+    header.graph_hash = data.graph_hash;
+    header.table_hash = table.contentHash();
+    if (!table.getFileStat(header.table_size, header.table_modified)) {
+        return false;
+    }
+
+    size_t starts[GRAPH_FILE_SECTIONS];
+    size_t sizes[GRAPH_FILE_SECTIONS];
+    size_t file_size = layout(header, starts, sizes);
+    const void* sections[GRAPH_FILE_SECTIONS] = { data.node_ids.data(),
+        data.node_flags.data(), data.offsets.data(), data.targets.data(),
+        data.reverse.data(), data.speeds.data(), data.components.data(),
+        data.string_offsets.data(), data.strings.data() };
+
+    // write aside, so a reader never maps a half written file
+    std::string temporary_name = std::string(file_name) + GRAPH_FILE_TEMPORARY;
+    FILE* fp = std::fopen(temporary_name.c_str(), "wb");
+    if (fp == NULL) {
+        return false;
+    }
+
+    static const char padding[GRAPH_FILE_ALIGNMENT] = { 0 };
+    bool ok = std::fwrite(&header, sizeof(graphFileHeader), 1, fp) == 1;
+    size_t position = sizeof(graphFileHeader);
+
+    // each section is padded up to where the next one starts
+    for (size_t section = 0; section <= GRAPH_FILE_SECTIONS && ok; section++) {
+        size_t start = section < GRAPH_FILE_SECTIONS ? starts[section]
+                                                     : file_size;
+        ok = std::fwrite(padding, 1, start - position, fp) == start - position;
+        position = start;
+
+        if (ok && section < GRAPH_FILE_SECTIONS) {
+            ok = std::fwrite(sections[section], 1, sizes[section], fp)
+                == sizes[section];
+            position += sizes[section];
+        }
+    }
+
+    ok = std::fclose(fp) == 0 && ok;
+    if (!ok || std::rename(temporary_name.c_str(), file_name) != 0) {
+        std::remove(temporary_name.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+uint32_t GraphFile::numNodes() const { return header->num_nodes; }
+
+uint32_t GraphFile::numEdges() const { return header->num_edges; }
+
+uint64_t GraphFile::graphHash() const { return header->graph_hash; }
+
+const int32_t* GraphFile::nodeIds() const { return node_ids; }
+
+const uint8_t* GraphFile::nodeFlags() const { return node_flags; }
+
+const uint32_t* GraphFile::csrOffsets() const { return offsets; }
+
+const uint32_t* GraphFile::csrTargets() const { return targets; }
+
+const uint32_t* GraphFile::csrReverse() const { return reverse; }
+
+const double* GraphFile::edgeSpeeds() const { return speeds; }
+
+const uint32_t* GraphFile::nodeComponents() const { return components; }
+
+std::string_view GraphFile::nodeString(uint32_t node, uint32_t field) const {
+    size_t string = (size_t)node * GRAPH_FILE_STRINGS_PER_NODE + field;
+    return std::string_view(strings + string_offsets[string],
+        string_offsets[string + 1] - string_offsets[string]);
+}
+
+GraphFile::GraphFile() {
+    mapping = NULL;
+    mapping_size = 0;
+    header = NULL;
+}
+
+GraphFile::~GraphFile() { close(); }
@@ -0,0 +1,173 @@
+#ifndef __GRAPH_FILE_HPP__
+#define __GRAPH_FILE_HPP__
+
+#include <cinttypes>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "table.hpp"
+
+#ifndef ACRONYM_SIZE
+#define ACRONYM_SIZE 2
+#endif
+
+// the magic at the start of graph files, its last character is the version.
+#define GRAPH_FILE_MAGIC "NETGRPH2"
+#define GRAPH_FILE_MAGIC_SIZE 8
+
+// the extension added to a table's name to name its graph file.
+#define GRAPH_FILE_EXTENSION ".graph"
+
+// every section of a graph file starts at a multiple of this many bytes.
+#define GRAPH_FILE_ALIGNMENT 8
+
+/*
+ * the strings stored for each node in a graph file, in this order: its
+ * country's acronym (always ACRONYM_SIZE characters, even if empty), its POP's
+ * name and its country's name.
+ */
+#define GRAPH_FILE_STRINGS_PER_NODE 3
+
+/*
+ * struct graphFileHeader is the header at the start of a graph file: the
+ * sizes of its sections, the hash of its graph (see GraphFileData), and the
+ * header fields, file size, modification time (in nanoseconds) and content
+ * hash of the table it was built from, used to tell if it is stale.
+ */
+struct graphFileHeader {
+    char magic[GRAPH_FILE_MAGIC_SIZE];
+    uint32_t num_nodes;
+    uint32_t num_edges; // CSR edges, i.e., both directions of a connection.
+    uint32_t next_rrn;
+    uint32_t entries_removed;
+    uint32_t times_compacted;
+    uint32_t strings_size;
+    uint64_t graph_hash;
+    uint64_t table_size;
+    int64_t table_modified;
+    uint64_t table_hash;
+};
+
+/*
+ * struct GraphFileData holds the sections of a graph file to be written, in
+ * the same format GraphFile reads them (see its accessors), and a hash of the
+ * graph, saved for its readers (see NetworkGraph::topologyHash).
+ */
+struct GraphFileData {
+    uint64_t graph_hash;
+    std::vector<int32_t> node_ids;
+    std::vector<uint8_t> node_flags;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<uint32_t> reverse;
+    std::vector<double> speeds;
+    std::vector<uint32_t> components;
+    std::vector<uint32_t> string_offsets;
+    std::string strings;
+};
+
+/*
+ * class GraphFile is a frozen NetworkGraph stored in a binary file, in the
+ * same CSR layout Graph uses (see Graph's CSR attributes). The file is a
+ * graphFileHeader followed by one aligned section for each array, and it is
+ * memory mapped, so every array is used in place, without any decoding.
+ *
+ * Opening a file and checking it is fresh take constant time: only what is
+ * needed to map the sections is checked, since files are only written by
+ * write, whole. The checks that read the whole file or table (isValid and
+ * the table's content hash) are optional.
+ */
+class GraphFile {
+private:
+    const char* mapping; // the whole file, NULL if no file is open.
+    size_t mapping_size;
+    const graphFileHeader* header;
+
+    // the sections, pointing inside mapping.
+    const int32_t* node_ids;
+    const uint8_t* node_flags;
+    const uint32_t* offsets;
+    const uint32_t* targets;
+    const uint32_t* reverse;
+    const double* speeds;
+    const uint32_t* components;
+    const uint32_t* string_offsets;
+    const char* strings;
+
+    /*
+     * layout calculates where each section of a file with the sizes in
+     * header starts and how many bytes it has (without its padding), in the
+     * same order as the attributes above, returning the size of the file.
+     */
+    static size_t layout(
+        const graphFileHeader& header, size_t* starts, size_t* sizes);
+
+    void close(); // close unmaps the file, if any.
+
+public:
+    /*
+     * open maps the graph file named file_name, returning false (and leaving
+     * no file open) if it could not be read, or if its header does not match
+     * its size or the ends of its offsets sections.
+     */
+    bool open(const char* file_name);
+
+    /*
+     * isValid returns whether every element of the open file's sections is
+     * consistent with the others, so that reading them never goes out of
+     * bounds. It reads the whole file.
+     */
+    bool isValid() const;
+
+    /*
+     * isFresh returns whether the open file was built from table as it is
+     * now, by comparing the table's header fields, file size and modification
+     * time with the ones saved in the file. If verify is set, the table's
+     * content hash (see Table::contentHash), which reads the whole table, is
+     * compared too.
+     */
+    bool isFresh(const Table& table, bool verify) const;
+
+    /*
+     * write writes data, built from table, to the graph file named
+     * file_name, returning false if it could not be written. The file is
+     * written aside and then renamed, so readers never see it incomplete.
+     */
+    static bool write(
+        const char* file_name, const Table& table, const GraphFileData& data);
+
+    uint32_t numNodes() const; // numNodes returns the number of nodes.
+    uint32_t numEdges() const; // numEdges returns the number of CSR edges.
+    uint64_t graphHash() const; // graphHash returns the graph's saved hash.
+
+    /*
+     * The accessors below return the sections: csrOffsets, csrTargets and
+     * csrReverse are the same as Graph's csr_offsets, csr_targets and
+     * csr_reverse, nodeIds and nodeComponents are the same as csr_node_ids
+     * and csr_components, edgeSpeeds has the speed of each edge, and
+     * nodeFlags is 0 for empty nodes and 1 for the others.
+     */
+    const int32_t* nodeIds() const;
+    const uint8_t* nodeFlags() const;
+    const uint32_t* csrOffsets() const;
+    const uint32_t* csrTargets() const;
+    const uint32_t* csrReverse() const;
+    const double* edgeSpeeds() const;
+    const uint32_t* nodeComponents() const;
+
+    /*
+     * nodeString returns the string number field (see
+     * GRAPH_FILE_STRINGS_PER_NODE) of the node with dense index node.
+     */
+    std::string_view nodeString(uint32_t node, uint32_t field) const;
+
+    GraphFile(); // Constructs a GraphFile with no file open.
+    ~GraphFile();
+
+    GraphFile(const GraphFile&) = delete;
+    GraphFile& operator=(const GraphFile&) = delete;
+};
+
+#endif
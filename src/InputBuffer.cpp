@@ -0,0 +1,209 @@
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "InputBuffer.hpp"
+
+// isSpace returns whether character is whitespace in the C locale.
+static bool isSpace(char character) {
+    return character == ' ' || (character >= '\t' && character <= '\r');
+}
+
+bool InputBuffer::refill() {
+    while (!ended) {
+        // keep the text not read yet, which is the start of a token
+        size_t kept = filled - begin;
+        std::memmove(buffer.data(), begin, kept);
+        if (kept == buffer.size()) {
+            buffer.resize(2 * buffer.size());
+        }
+
+        ssize_t received;
+        do {
+            received = ::read(fd, buffer.data() + kept, buffer.size() - kept);
+        } while (received == -1 && errno == EINTR);
+
+        begin = buffer.data();
+        filled = buffer.data() + kept;
+        if (received <= 0) {
+            ended = true;
+            end = filled;
+            return kept > 0;
+        }
+
+        // a token that reaches the end of the block may go on in the next
+        filled += received;
+        end = filled;
+        while (end > begin && !isSpace(end[-1])) {
+            end--;
+        }
+
+        if (end > begin) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool InputBuffer::nextToken() {
+    while (true) {
+        while (begin < end && isSpace(*begin)) {
+            begin++;
+        }
+
+        if (begin < end) {
+            return true;
+        }
+
+        if (!refill()) {
+            return false;
+        }
+    }
+}
+
+bool InputBuffer::read(int32_t& number) {
+    number = 0;
+    if (failed || !nextToken()) {
+        failed = true;
+        return false;
+    }
+
+    // from_chars does not take the plus sign that istreams take
+    const char* first = begin;
+    if (*first == '+' && first + 1 < end && first[1] >= '0'
+        && first[1] <= '9') {
+        first++;
+    }
+
+    std::from_chars_result result = std::from_chars(first, end, number);
+    if (result.ec == std::errc::result_out_of_range) {
+        number = *begin == '-' ? std::numeric_limits<int32_t>::min()
+                               : std::numeric_limits<int32_t>::max();
+    }
+
+    if (result.ec != std::errc()) {
+        failed = true;
+        return false;
+    }
+
+    begin = result.ptr;
+    return true;
+}
+
+bool InputBuffer::read(std::string& word) {
+    if (failed || !nextToken()) {
+        failed = true;
+        return false;
+    }
+
+    const char* word_end = begin;
+    while (word_end < end && !isSpace(*word_end)) {
+        word_end++;
+    }
+
+    word.assign(begin, word_end);
+    begin = word_end;
+    return true;
+}
+
+bool InputBuffer::readColumns(size_t num_rows,
+    std::initializer_list<std::vector<int32_t>*> columns) {
+
+    for (std::vector<int32_t>* column : columns) {
+        column->resize(num_rows);
+    }
+
+    for (size_t row = 0; row < num_rows; row++) {
+        for (std::vector<int32_t>* column : columns) {
+            read((*column)[row]);
+        }
+    }
+
+    return !failed;
+}
+
+bool InputBuffer::readLine(std::string& line) {
+    line.clear();
+
+    while (true) {
+        // every '\n' read so far is before end, since it is whitespace
+        const char* newline
+            = (const char*)std::memchr(begin, '\n', end - begin);
+        if (newline != NULL) {
+            line.assign(begin, newline);
+            begin = newline + 1;
+            return true;
+        }
+
+        if (ended) {
+            // the last line may not end with a '\n'
+            if (begin == filled) {
+                return false;
+            }
+
+            line.assign(begin, filled);
+            begin = filled;
+            end = filled;
+            return true;
+        }
+
+        refill();
+    }
+}
+
+InputBuffer::InputBuffer(int fd) {
+    this->fd = fd;
+    mapping = NULL;
+    mapping_size = 0;
+    ended = false;
+    failed = false;
+
+    // a regular file can be read in place from where it is positioned
+    struct stat file_stat;
+    off_t offset = lseek(fd, 0, SEEK_CUR);
+    if (offset != -1 && fstat(fd, &file_stat) == 0
+        && S_ISREG(file_stat.st_mode) && file_stat.st_size > offset) {
+        void* address
+            = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (address != MAP_FAILED) {
+            mapping = (const char*)address;
+            mapping_size = file_stat.st_size;
+            begin = mapping + offset;
+            end = mapping + mapping_size;
+            filled = end;
+            ended = true;
+
+            // the whole file counts as read by fd's other users
+            lseek(fd, 0, SEEK_END);
+            return;
+        }
+    }
+
+    buffer.resize(INPUT_BUFFER_SIZE);
+    begin = buffer.data();
+    end = buffer.data();
+    filled = buffer.data();
+}
+
+InputBuffer::InputBuffer(std::string_view text) {
+    fd = -1;
+    mapping = NULL;
+    mapping_size = 0;
+    begin = text.data();
+    end = text.data() + text.size();
+    filled = end;
+    ended = true;
+    failed = false;
+}
+
+InputBuffer::~InputBuffer() {
+    if (mapping != NULL) {
+        munmap((void*)mapping, mapping_size);
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef __INPUT_BUFFER_HPP__
+#define __INPUT_BUFFER_HPP__
+
+#include <cinttypes>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// how many bytes an InputBuffer reads from its file at a time.
+#define INPUT_BUFFER_SIZE (1 << 20)
+
+/*
+ * class InputBuffer reads whitespace separated tokens from a file descriptor
+ * or from text in memory, the same way as an istream with operator>>, but
+ * without locales, stream state or synchronization with stdio. If the file
+ * is a regular file, the rest of it is memory mapped and read in place.
+ * Otherwise, it is read in large blocks, each as soon as some of it is
+ * available, so requests in a pipe or terminal are answered as they come.
+ * Integers are parsed with std::from_chars.
+ *
+ * As with an istream, a read that fails (at the end of the input, or on a
+ * token that is not a valid number) makes every later read fail too.
+ */
+class InputBuffer {
+private:
+    int fd; // the file being read, -1 if all of the text is in memory.
+    std::vector<char> buffer; // the blocks read from fd.
+    const char* mapping; // the mapped file, NULL if it is not mapped.
+    size_t mapping_size;
+
+    /*
+     * the text not read yet goes from begin up to (but not including) filled,
+     * pointing either inside buffer, inside mapping or at the given text.
+     * Only the tokens before end are known to be whole: end is just after
+     * the last whitespace read, or the same as filled when there is no more
+     * text to read, so tokens are parsed in a single pass.
+     */
+    const char* begin;
+    const char* end;
+    const char* filled;
+
+    bool ended; // whether there is no more text to read from fd.
+    bool failed; // whether a read failed.
+
+    /*
+     * refill moves the text not read yet to the start of buffer and reads
+     * more after it, growing buffer if it is full, until end moves. It
+     * returns false if there was nothing more to read.
+     */
+    bool refill();
+
+    /*
+     * nextToken skips whitespace, reading more from fd if needed, until begin
+     * is at the start of a whole token. It returns false if the text ended.
+     */
+    bool nextToken();
+
+public:
+    /*
+     * read reads an integer from the start of the next token into number,
+     * leaving the rest of the token to be read next. It returns false if the
+     * token does not start with a 32-bit integer, in which case number is 0
+     * (or the closest limit, if it is too large), the same as an istream.
+     */
+    bool read(int32_t& number);
+
+    // read reads the next token into word, returning false if there is none.
+    bool read(std::string& word);
+
+    /*
+     * readColumns reads num_rows rows of columns.size() integers each,
+     * storing each integer in the vector of its column, resized to num_rows.
+     * It returns false if any read failed, but the columns always have
+     * num_rows integers, those not read being 0.
+     */
+    bool readColumns(size_t num_rows,
+        std::initializer_list<std::vector<int32_t>*> columns);
+
+    /*
+     * readLine reads the rest of the current line into line, without its
+     * '\n', returning false if the text ended. Unlike the other reads, it
+     * works even after one of them failed.
+     */
+    bool readLine(std::string& line);
+
+    InputBuffer(int fd); // Constructs an InputBuffer over fd, see above.
+    InputBuffer(std::string_view text); // Constructs one over text.
+    ~InputBuffer();
+
+    InputBuffer(const InputBuffer&) = delete;
+    InputBuffer& operator=(const InputBuffer&) = delete;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <limits>
+
+#include "CSRArray.hxx"
+#include "MaxFlow.hpp"
+
+bool MaxFlow::buildLevels(const CSRArray<uint32_t>& offsets,
+    const CSRArray<uint32_t>& targets, uint32_t source, uint32_t sink) {
+
+    std::fill(levels.begin(), levels.end(), -1);
+    queue.clear();
+
+    levels[source] = 0;
+    queue.push_back(source);
+
+    for (size_t front = 0; front < queue.size(); front++) {
+        uint32_t node = queue[front];
+
+        for (uint32_t edge = offsets[node]; edge < offsets[node + 1]; edge++) {
+            uint32_t next = targets[edge];
+            if (levels[next] == -1 && residuals[edge] > 0) {
+                levels[next] = levels[node] + 1;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    return levels[sink] != -1;
+}
+
+double MaxFlow::augment(const CSRArray<uint32_t>& offsets,
+    const CSRArray<uint32_t>& targets, const CSRArray<uint32_t>& reverse,
+    uint32_t source, uint32_t sink) {
+
+    // every node starts trying from its first edge
+    std::copy(offsets.begin(), offsets.end() - 1, next_edges.begin());
+    path.clear();
+
+    double flow = 0;
+    uint32_t node = source;
+
+    while (true) {
+        if (node == sink) {
+            // the bottleneck of the path is the flow it can take
+            double path_flow = std::numeric_limits<double>::infinity();
+            for (uint32_t edge : path) {
+                path_flow = std::min(path_flow, residuals[edge]);
+            }
+
+            for (uint32_t edge : path) {
+                residuals[edge] -= path_flow;
+                residuals[reverse[edge]] += path_flow;
+            }
+            flow += path_flow;
+            num_paths++;
+
+            // go back to the tail of the first saturated edge
+            size_t saturated = 0;
+            while (residuals[path[saturated]] > 0) {
+                saturated++;
+            }
+
+            node = targets[reverse[path[saturated]]];
+            path.resize(saturated);
+            continue;
+        }
+
+        // advance through the next edge that goes one level deeper
+        uint32_t& edge = next_edges[node];
+        while (edge < offsets[node + 1]
+            && (residuals[edge] <= 0
+                || levels[targets[edge]] != levels[node] + 1)) {
+            edge++;
+        }
+
+        if (edge < offsets[node + 1]) {
+            path.push_back(edge);
+            node = targets[edge];
+            continue;
+        }
+
+        // dead end: no path goes through this node anymore, so retreat
+        if (node == source) {
+            return flow;
+        }
+
+        levels[node] = -1;
+        node = targets[reverse[path.back()]];
+        path.pop_back();
+        next_edges[node]++;
+    }
+}
+
+bool MaxFlow::isSourceSide(uint32_t node) const {
+    // the last BFS failed to reach the sink, so its levels are the cut
+    return levels[node] != -1;
+}
+
+size_t MaxFlow::numAugmentingPaths() const { return num_paths; }
+
+MaxFlow::MaxFlow() { num_paths = 0; }
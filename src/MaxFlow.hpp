@@ -0,0 +1,69 @@
+#ifndef __MAX_FLOW_HPP__
+#define __MAX_FLOW_HPP__
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+#include "CSRArray.hpp"
+
+/*
+ * class MaxFlow is a maximum flow engine (Dinic's algorithm) over
+ * non-directed graphs in the CSR layout of Graph. Each edge and its reverse
+ * share the same capacity, in the same way as a pair of opposite arcs that are
+ * each other's residual arcs. Residual capacities, levels and the other
+ * buffers are flat arrays indexed by CSR edge position or dense node index,
+ * kept between runs so the engine can be reused.
+ */
+class MaxFlow {
+private:
+    std::vector<double> residuals; // residual capacity of each edge.
+    std::vector<int32_t> levels; // BFS level of each node, -1 if unreached.
+    std::vector<uint32_t> next_edges; // next edge to try for each node.
+    std::vector<uint32_t> queue; // BFS queue.
+    std::vector<uint32_t> path; // edges of the current augmenting path.
+    size_t num_paths; // augmenting paths found by the last run.
+
+    /*
+     * buildLevels runs a BFS from source over edges with residual capacity,
+     * returning whether sink was reached.
+     */
+    bool buildLevels(const CSRArray<uint32_t>& offsets,
+        const CSRArray<uint32_t>& targets, uint32_t source, uint32_t sink);
+
+    /*
+     * augment finds augmenting paths in the level graph with an iterative
+     * DFS until the flow is blocking, returning the flow added.
+     */
+    double augment(const CSRArray<uint32_t>& offsets,
+        const CSRArray<uint32_t>& targets, const CSRArray<uint32_t>& reverse,
+        uint32_t source, uint32_t sink);
+
+public:
+    /*
+     * run calculates the maximum flow from source to sink in the graph given
+     * by offsets, targets and edges (see Graph's CSR layout), where edges is
+     * any array indexed by edge position, reverse[i] is the position of the
+     * edge opposite to edge i and capacity(edges[i]) is its capacity. Source
+     * and sink must be different.
+     */
+    template <class Edges, class Capacity>
+    double run(const CSRArray<uint32_t>& offsets,
+        const CSRArray<uint32_t>& targets, const CSRArray<uint32_t>& reverse,
+        const Edges& edges, Capacity capacity, uint32_t source,
+        uint32_t sink);
+
+    /*
+     * isSourceSide returns whether node is in the source side of the minimum
+     * cut found by the last run, i.e., if it can still be reached from the
+     * source through edges with residual capacity.
+     */
+    bool isSourceSide(uint32_t node) const;
+
+    // numAugmentingPaths returns how many paths the last run augmented.
+    size_t numAugmentingPaths() const;
+
+    MaxFlow(); // Constructs an engine that has not run yet.
+};
+
+#endif
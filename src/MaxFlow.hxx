@@ -0,0 +1,31 @@
+#ifndef __MAX_FLOW_HXX__
+#define __MAX_FLOW_HXX__
+
+#include "CSRArray.hxx"
+#include "MaxFlow.hpp"
+
+template <class Edges, class Capacity>
+double MaxFlow::run(const CSRArray<uint32_t>& offsets,
+    const CSRArray<uint32_t>& targets, const CSRArray<uint32_t>& reverse,
+    const Edges& edges, Capacity capacity, uint32_t source, uint32_t sink) {
+
+    // no flow was sent yet, every edge has its full capacity
+    residuals.resize(edges.size());
+    for (size_t edge = 0; edge < edges.size(); edge++) {
+        residuals[edge] = capacity(edges[edge]);
+    }
+
+    levels.resize(offsets.size() - 1);
+    next_edges.resize(offsets.size() - 1);
+
+    // each phase saturates all shortest augmenting paths
+    double flow = 0;
+    num_paths = 0;
+    while (buildLevels(offsets, targets, source, sink)) {
+        flow += augment(offsets, targets, reverse, source, sink);
+    }
+
+    return flow;
+}
+
+#endif
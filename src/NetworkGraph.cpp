@@ -1,10 +1,16 @@
+#include <algorithm>
 #include <limits>
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Graph.hxx"
 #include "NetworkGraph.hpp"
+#include "Stats.hpp"
+#include "Trace.hpp"
+#include "UnionFind.hpp"
 #include "table.hpp"
 
 extern "C" {
@@ -17,6 +23,11 @@ std::ostream& operator<<(std::ostream& os, const NetworkNode& node) {
               << node.countryAcronym[1];
 }
 
+OutputBuffer& operator<<(OutputBuffer& ob, const NetworkNode& node) {
+    return ob << node.idKey() << ' ' << node.POPsName << ' '
+              << node.originCountryName << ' ' << node.getCountryAcronym();
+}
+
 NetworkNode::NetworkNode(entry* es)
     : Node(GET_IDCONNECT(es)) {
     if (GET_IDCONNECT(es) == EMPTY_VALUE) {
@@ -32,11 +43,55 @@ NetworkNode::NetworkNode(entry* es)
     }
 }
 
+NetworkNode::NetworkNode(const EntryView& view)
+    : Node(view.idConnect()) {
+    if (view.idConnect() == EMPTY_VALUE) {
+        throw std::runtime_error(
+            "Cannot construct NetworkNode from empty entry");
+    }
+
+    POPsName = std::string(view.poPsName());
+    originCountryName = std::string(view.countryName());
+
+    for (size_t index = 0; index < ACRONYM_SIZE; index++) {
+        countryAcronym[index] = view.countryAcro()[index];
+    }
+}
+
+NetworkNode::NetworkNode(int32_t id, std::string_view country_acronym,
+    std::string_view POPs_name, std::string_view origin_country_name)
+    : Node(id) {
+    if (id == EMPTY_VALUE) {
+        throw std::runtime_error("Cannot construct NetworkNode with empty id");
+    }
+
+    POPsName = std::string(POPs_name);
+    originCountryName = std::string(origin_country_name);
+
+    for (size_t index = 0; index < ACRONYM_SIZE; index++) {
+        countryAcronym[index] = country_acronym[index];
+    }
+}
+
+std::string_view NetworkNode::getCountryAcronym() const {
+    return std::string_view(countryAcronym, ACRONYM_SIZE);
+}
+
+const std::string& NetworkNode::getPOPsName() const { return POPsName; }
+
+const std::string& NetworkNode::getOriginCountryName() const {
+    return originCountryName;
+}
+
 std::ostream& operator<<(std::ostream& os, const Connection& conn) {
     return os << conn.idTo() << " " << conn.connectionSpeed << "Mbps";
 }
 
-double Connection::getSpeed() { return connectionSpeed; }
+OutputBuffer& operator<<(OutputBuffer& ob, const Connection& conn) {
+    return ob << conn.idTo() << ' ' << conn.connectionSpeed << "Mbps";
+}
+
+double Connection::getSpeed() const { return connectionSpeed; }
 
 Connection::Connection(entry* es)
     : Edge(GET_IDCONNECT(es), GET_CONNPOPSID(es)) {
@@ -49,22 +104,42 @@ Connection::Connection(entry* es)
             "Connected POP's ID. It must be a valid address.");
     }
 
+    connectionSpeed = toMbps(GET_SPEED(es), GET_MEASUREMENT_UNIT(es)[0]);
+}
+
+Connection::Connection(const EntryView& view)
+    : Edge(view.idConnect(), view.connPoPsId()) {
+    if (idFrom() == EMPTY_VALUE) {
+        throw std::runtime_error("Cannot construct connection with empty "
+                                 "idConnect. It must be a valid address.");
+    } else if (idTo() == EMPTY_VALUE) {
+        throw std::runtime_error(
+            "Cannot construct connnection with empty "
+            "Connected POP's ID. It must be a valid address.");
+    }
+
+    connectionSpeed = toMbps(view.speed(), view.measurementUnit());
+}
+
+Connection::Connection(int32_t id_from, int32_t id_to, double speed)
+    : Edge(id_from, id_to) {
+    connectionSpeed = speed;
+}
+
+double Connection::toMbps(int32_t speed, char unit) {
     // Convert speed units to megabytes per second (Mbps).
-    switch (GET_MEASUREMENT_UNIT(es)[0]) {
+    switch (unit) {
     case 'K':
     case 'k':
-        connectionSpeed = GET_SPEED(es) / (CONVERSION_FACTOR);
-        break;
+        return speed / (CONVERSION_FACTOR);
 
     case 'M':
     case 'm':
-        connectionSpeed = GET_SPEED(es);
-        break;
+        return speed;
 
     case 'G':
     case 'g':
-        connectionSpeed = GET_SPEED(es) * CONVERSION_FACTOR;
-        break;
+        return speed * CONVERSION_FACTOR;
 
     default:
         throw std::runtime_error("Invalid measurement unit");
@@ -76,253 +151,670 @@ Connection::Connection()
     connectionSpeed = -1;
 }
 
-NetworkGraph::NetworkGraph(const Table& table) {
-    // for each entry
-    for (entry* es; (es = table.readNextEntry()) != NULL; deleteEntry(es, 1)) {
-        try {
-            // if the entry is not empty, insert the corresponding node if
-            // needed
-            NetworkNode new_pop = NetworkNode(es);
-            Graph::insertNode(new_pop);
-        } catch (std::runtime_error& except) {
+/*
+ * struct ScanResult holds the nodes and connections found by a thread while
+ * scanning a range of a table, in RRN order.
+ */
+struct ScanResult {
+    std::vector<NetworkNode> nodes;
+    std::vector<Connection> connections;
+};
+
+/*
+ * scanEntries views every entry with RRN in [first_rrn, last_rrn) of table,
+ * storing in result the nodes and connections that should be inserted in the
+ * graph.
+ */
+static void scanEntries(const Table& table, size_t first_rrn, size_t last_rrn,
+    ScanResult& result) {
+
+    TraceScope trace("table_scan", "first_rrn", first_rrn, "last_rrn",
+        last_rrn);
+    char buffer[MAX_SIZE_ENTRY];
+    EntryView view;
+    uint64_t records_read = 0;
+    uint64_t removed_records = 0;
+
+    for (size_t rrn = first_rrn; rrn < last_rrn; rrn++) {
+        if (!table.viewEntry(rrn, view, buffer)) {
+            break; // the table ended before expected.
+        }
+        records_read++;
+
+        if (view.isRemoved()) {
+            removed_records++;
+            continue; // Do not insert removed nodes and edges.
+        }
+
+        if (view.idConnect() == EMPTY_VALUE) {
             continue; // Do not insert empty nodes and edges.
         }
 
+        // if the entry is not empty, the corresponding node is inserted
+        result.nodes.push_back(NetworkNode(view));
+
+        if (view.connPoPsId() == EMPTY_VALUE) {
+            continue; // Do not insert empty edges.
+        }
+
         try {
-            // if the connection is not empty, insert it in the graph
-            Connection new_connection = Connection(es);
-            Graph::insertEdge(new_connection);
+            // if the connection is not empty, it is inserted in the graph
+            result.connections.push_back(Connection(view));
         } catch (std::runtime_error& except) { }
     }
+
+    Stats::add(stat_records_read, records_read);
+    Stats::add(stat_removed_records_skipped, removed_records);
 }
 
-std::ostream& operator<<(std::ostream& os, const NetworkGraph& graph) {
+NetworkGraph::NetworkGraph(const Table& table)
+    : NetworkGraph(table, std::thread::hardware_concurrency()) { }
+
+NetworkGraph::NetworkGraph(const Table& table, uint32_t num_threads) {
+    StatTimer timer(stat_graph_build);
+    TraceScope trace("graph_build", "entries", table.entryCount());
+    speeds_version = 0;
+    max_speed_tree_version = 0;
+    widest_speed_tree_version = 0;
+    size_t entries = table.entryCount();
+
+    // do not spawn threads that would have almost nothing to do
+    size_t max_threads = entries / MIN_ENTRIES_PER_THREAD + 1;
+    num_threads
+        = std::max<size_t>(1, std::min<size_t>(num_threads, max_threads));
+
+    // split the RRNs in contiguous, disjoint ranges, one for each thread
+    std::vector<ScanResult> results(num_threads);
+    std::vector<std::thread> threads;
+    size_t range_size = (entries + num_threads - 1) / num_threads;
+
+    for (uint32_t i = 1; i < num_threads; i++) {
+        size_t first_rrn = std::min(entries, i * range_size);
+        size_t last_rrn = std::min(entries, first_rrn + range_size);
+
+        threads.push_back(std::thread(scanEntries, std::cref(table), first_rrn,
+            last_rrn, std::ref(results[i])));
+    }
+
+    // the current thread scans the first range
+    scanEntries(table, 0, std::min(entries, range_size), results[0]);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // merge in RRN order, so the first entry of a node is the one kept
+    std::vector<Connection> connections;
+    for (auto& result : results) {
+        for (auto& new_pop : result.nodes) {
+            Graph::insertNode(new_pop);
+        }
+
+        connections.insert(connections.end(), result.connections.begin(),
+            result.connections.end());
+        result.connections.clear();
+    }
+
+    // all connections are inserted at once, see Graph::insertEdges
+    Graph::insertEdges(connections);
+
+    freeze();
+}
+
+NetworkGraph::NetworkGraph(std::unique_ptr<GraphFile> file) {
+    StatTimer timer(stat_graph_load);
+    TraceScope trace("graph_load", "nodes", file->numNodes());
+    max_speed_tree_version = 0;
+    widest_speed_tree_version = 0;
+
+    uint32_t num_nodes = file->numNodes();
+    uint32_t num_edges = file->numEdges();
+    csr_node_ids.view(file->nodeIds(), num_nodes);
+    csr_node_flags.view(file->nodeFlags(), num_nodes);
+    csr_offsets.view(file->csrOffsets(), num_nodes + 1);
+    csr_targets.view(file->csrTargets(), num_edges);
+    csr_reverse.view(file->csrReverse(), num_edges);
+    csr_components.view(file->nodeComponents(), num_nodes);
+    csr_speeds.view(file->edgeSpeeds(), num_edges);
+    graph_file = std::move(file);
+
+    csr_version++;
+    speeds_version = csr_version;
+    frozen = true;
+}
+
+void NetworkGraph::unmapGraphFile() {
+    if (graph_file == nullptr) {
+        return;
+    }
+
+    // node keys are sorted, so every node goes at the end of node_list
+    csr_edges.clear();
+    csr_edges.reserve(csr_targets.size());
+    for (uint32_t node = 0; node < csr_node_ids.size(); node++) {
+        int32_t node_id = csr_node_ids[node];
+        if (csr_node_flags[node] == 0) {
+            node_list.emplace_hint(node_list.end(), node_id, NetworkNode());
+        } else {
+            node_list.emplace_hint(node_list.end(), node_id,
+                NetworkNode(node_id, graph_file->nodeString(node, 0),
+                    graph_file->nodeString(node, 1),
+                    graph_file->nodeString(node, 2)));
+        }
+
+        for (uint32_t edge = csr_offsets[node]; edge < csr_offsets[node + 1];
+             edge++) {
+            csr_edges.push_back(Connection(node_id,
+                csr_node_ids[csr_targets[edge]], csr_speeds[edge]));
+        }
+    }
+
+    csr_node_ids.own();
+    csr_node_flags.own();
+    csr_offsets.own();
+    csr_targets.own();
+    csr_reverse.own();
+    csr_components.own();
+    csr_speeds.own();
+    graph_file.reset();
+
+    adoptCSR();
+    speeds_version = csr_version;
+}
+
+void NetworkGraph::insertNode(const NetworkNode& new_node) {
+    unmapGraphFile();
+    Graph::insertNode(new_node);
+}
+
+void NetworkGraph::insertEdge(Connection& new_edge) {
+    unmapGraphFile();
+    Graph::insertEdge(new_edge);
+}
+
+void NetworkGraph::insertEdges(const std::vector<Connection>& new_edges) {
+    unmapGraphFile();
+    Graph::insertEdges(new_edges);
+}
+
+void NetworkGraph::freeze() {
+    Graph::freeze();
+    if (speeds_version == csr_version) {
+        return;
+    }
+
+    std::vector<double> speeds;
+    speeds.reserve(csr_edges.size());
+    for (auto& conn : csr_edges) {
+        speeds.push_back(conn.getSpeed());
+    }
+
+    csr_speeds.assign(std::move(speeds));
+    speeds_version = csr_version;
+}
+
+NetworkGraph* NetworkGraph::fromGraphFile(
+    const Table& table, const char* file_name, bool verify) {
+
+    std::string max_speed_file_name
+        = std::string(file_name) + MAX_SPEED_FILE_EXTENSION;
+
+    NetworkGraph* graph;
+    std::unique_ptr<GraphFile> file(new GraphFile());
+    if (file->open(file_name) && file->isFresh(table, verify)
+        && (!verify || file->isValid())) {
+        graph = new NetworkGraph(std::move(file));
+    } else {
+        graph = new NetworkGraph(table);
+        graph->saveGraph(table, file_name);
+    }
+
+    graph->useMaxSpeedFile(max_speed_file_name.c_str());
+    return graph;
+}
+
+bool NetworkGraph::saveGraph(const Table& table, const char* file_name) {
+    // the node strings are written from node_list
+    unmapGraphFile();
+    freeze();
+
+    GraphFileData data;
+    data.node_ids.assign(csr_node_ids.begin(), csr_node_ids.end());
+    data.node_flags.assign(csr_node_flags.begin(), csr_node_flags.end());
+    data.offsets.assign(csr_offsets.begin(), csr_offsets.end());
+    data.targets.assign(csr_targets.begin(), csr_targets.end());
+    data.reverse.assign(csr_reverse.begin(), csr_reverse.end());
+    data.speeds.assign(csr_speeds.begin(), csr_speeds.end());
+    data.components.assign(csr_components.begin(), csr_components.end());
+    data.graph_hash = topologyHash();
+
+    // empty nodes keep empty strings, and a blank acronym
+    data.string_offsets.reserve(
+        csr_node_ids.size() * GRAPH_FILE_STRINGS_PER_NODE + 1);
+    data.string_offsets.push_back(0);
+    for (auto& node : node_list) {
+        const NetworkNode& pop = node.second;
+        if (pop.isEmpty()) {
+            data.strings.append(ACRONYM_SIZE, ' ');
+        } else {
+            data.strings.append(pop.getCountryAcronym());
+        }
+        data.string_offsets.push_back(data.strings.size());
+
+        data.strings.append(pop.getPOPsName());
+        data.string_offsets.push_back(data.strings.size());
+
+        data.strings.append(pop.getOriginCountryName());
+        data.string_offsets.push_back(data.strings.size());
+    }
+
+    return GraphFile::write(file_name, table, data);
+}
+
+OutputBuffer& operator<<(OutputBuffer& ob, const NetworkGraph& graph) {
+    if (graph.graph_file != nullptr) {
+        // the same as below, with the node strings read from the file
+        const GraphFile& file = *graph.graph_file;
+        for (uint32_t node = 0; node < graph.csr_node_ids.size(); node++) {
+            if (graph.csr_node_flags[node] == 0) {
+                continue;
+            }
+
+            for (uint32_t edge = graph.csr_offsets[node];
+                 edge < graph.csr_offsets[node + 1]; edge++) {
+                ob << graph.csr_node_ids[node] << ' '
+                   << file.nodeString(node, 1) << ' '
+                   << file.nodeString(node, 2) << ' '
+                   << file.nodeString(node, 0) << ' '
+                   << graph.csr_node_ids[graph.csr_targets[edge]] << ' '
+                   << graph.csr_speeds[edge] << "Mbps\n";
+            }
+        }
+
+        return ob;
+    }
+
     // printing a full graph is the same as printing each node with each edge in
     // separated lines
-    for (auto node_it = graph.node_list.begin();
-         node_it != graph.node_list.end(); node_it++) {
-
-        if (node_it->second.isEmpty()) {
+    for (auto& node : graph.node_list) {
+        if (node.second.isEmpty()) {
             continue; // do not print empty NetworkNodes.
         }
 
-        std::vector<Connection> connections;
-
-        try {
-            // get all connections for a node
-            connections = graph.adjacencies.at(node_it->second.idKey());
-        } catch (std::out_of_range& e) {
+        // get all connections for a node, nodes without any have no list
+        auto adjacency_it = graph.adjacencies.find(node.first);
+        if (adjacency_it == graph.adjacencies.end()) {
             continue;
         }
 
-        for (auto edge_it = connections.begin(); edge_it != connections.end();
-             edge_it++) {
+        for (const Connection& conn : adjacency_it->second) {
             // print both the node and connection together
-            os << (*node_it).second << " " << *edge_it << std::endl;
+            ob << node.second << ' ' << conn << '\n';
         }
     }
 
+    return ob;
+}
+
+std::ostream& operator<<(std::ostream& os, const NetworkGraph& graph) {
+    OutputBuffer buffer(os);
+    buffer << graph;
     return os;
 }
 
-bool NetworkGraph::findPathWithFlow(std::vector<Connection>& path,
-    std::map<Edge, int32_t>& flow_used, std::map<int32_t, bool>& marks,
-    int32_t node_a_id, int32_t node_b_id) {
+double NetworkGraph::getMaxSpeed(int32_t node_a_id, int32_t node_b_id) {
+    freeze();
+    return getMaxSpeed(node_a_id, node_b_id, max_flow);
+}
 
-    // for every connection in the current node
-    for (auto conn : adjacencies[node_a_id]) {
-        // if the connection is marked, we already gone there
-        if (marks[conn.idTo()]) {
-            continue;
-        }
-        // if there is no bandwidth avaliable, we cannot use the connection
-        if (conn.getSpeed() <= flow_used[conn]) {
-            continue;
-        }
+double NetworkGraph::getMaxSpeed(
+    int32_t node_a_id, int32_t node_b_id, MaxFlow& flows) const {
+
+    StatTimer timer(stat_max_speed_query);
+    TraceScope trace(
+        "max_speed", "origin", node_a_id, "destination", node_b_id);
+
+    // if the origin or destination nodes do not exist, or do not have any
+    // connections, no path exists
+    ssize_t node_a = denseIndex(node_a_id);
+    ssize_t node_b = denseIndex(node_b_id);
+    if (!hasConnections(node_a) || !hasConnections(node_b)) {
+        return -1;
+    }
+
+    // no speed is needed to get to the same node
+    if (node_a == node_b) {
+        return 0;
+    }
+
+    // no flow can go between different components
+    if (!sameComponent(node_a, node_b)) {
+        return 0;
+    }
+
+    // if the tree is up to date, just query it
+    if (!max_speed_tree.empty() && max_speed_tree_version == csr_version) {
+        return max_speed_tree.minFlow(node_a, node_b);
+    }
 
-        // mark the node we will travel to and add to the path list
-        marks[conn.idTo()] = true;
-        path.push_back(conn);
+    double speed = flows.run(csr_offsets, csr_targets, csr_reverse,
+        csr_speeds, [](double speed) { return speed; }, node_a, node_b);
+    Stats::add(stat_augmenting_paths, flows.numAugmentingPaths());
 
-        // if the connected node is the destination, we found a path!
-        if (conn.idTo() == node_b_id) {
-            return true;
+    return speed;
+}
+
+uint64_t NetworkGraph::topologyHash() const {
+    if (graph_file != nullptr) {
+        return graph_file->graphHash();
+    }
+
+    // FNV-1a over every node key, edge offset, target and speed
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const void* data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ ((const uint8_t*)data)[i]) * 1099511628211ull;
         }
+    };
 
-        // travel to the next node trying to find a full path
-        bool found_path
-            = findPathWithFlow(path, flow_used, marks, conn.idTo(), node_b_id);
+    add(csr_node_ids.data(), csr_node_ids.size() * sizeof(int32_t));
+    add(csr_offsets.data(), csr_offsets.size() * sizeof(uint32_t));
+    add(csr_targets.data(), csr_targets.size() * sizeof(uint32_t));
+    add(csr_speeds.data(), csr_speeds.size() * sizeof(double));
 
-        // if we found a path, just return, no point in traveling to other nodes
-        if (found_path) {
-            return true;
+    return hash;
+}
+
+void NetworkGraph::precomputeMaxSpeeds() {
+    freeze();
+    if (!max_speed_tree.empty() && max_speed_tree_version == csr_version) {
+        return;
+    }
+
+    TraceScope trace("max_speed_tree", "nodes", csr_node_ids.size());
+
+    // every node starts hanging from the first one
+    uint32_t num_nodes = csr_node_ids.size();
+    std::vector<uint32_t> parents(num_nodes, 0);
+    std::vector<double> flows(num_nodes, 0);
+    uint64_t augmenting_paths = 0;
+
+    for (uint32_t node = 1; node < num_nodes; node++) {
+        // the minimum cut between the node and its parent
+        uint32_t parent = parents[node];
+        flows[node] = max_flow.run(csr_offsets, csr_targets, csr_reverse,
+            csr_speeds, [](double speed) { return speed; }, node, parent);
+        augmenting_paths += max_flow.numAugmentingPaths();
+
+        // later nodes on the node's side of the cut now hang from it
+        for (uint32_t other = node + 1; other < num_nodes; other++) {
+            if (parents[other] == parent && max_flow.isSourceSide(other)) {
+                parents[other] = node;
+            }
         }
+    }
+
+    Stats::add(stat_augmenting_paths, augmenting_paths);
+    max_speed_tree.build(parents, flows, topologyHash());
+    max_speed_tree_version = csr_version;
 
-        // pop the connection and unmark the node, we did not find a path
-        path.pop_back();
-        marks[conn.idTo()] = false;
+    // failing to save the tree only means it is built again next time
+    if (!max_speed_file_name.empty()) {
+        saveMaxSpeeds(max_speed_file_name.c_str());
+    }
+}
+
+bool NetworkGraph::saveMaxSpeeds(const char* file_name) {
+    precomputeMaxSpeeds();
+
+    // readers never see a half written tree, the old one is replaced whole
+    std::string temporary_name
+        = std::string(file_name) + MAX_SPEED_FILE_TEMPORARY;
+    FILE* fp = std::fopen(temporary_name.c_str(), "wb");
+    if (fp == NULL) {
+        return false;
+    }
+
+    bool saved = max_speed_tree.save(fp);
+    saved = std::fclose(fp) == 0 && saved
+        && std::rename(temporary_name.c_str(), file_name) == 0;
+    if (!saved) {
+        std::remove(temporary_name.c_str());
     }
 
-    // if no connections found any path, we did not find either
-    return false;
+    return saved;
 }
 
-std::vector<Connection> NetworkGraph::findPathWithFlow(
-    std::map<Edge, int32_t>& flow_used, int32_t node_a_id, int32_t node_b_id) {
+bool NetworkGraph::loadMaxSpeeds(const char* file_name) {
+    freeze();
 
-    std::vector<Connection> path {};
+    FILE* fp = std::fopen(file_name, "rb");
+    if (fp == NULL) {
+        return false;
+    }
 
-    // to keep track of recursion, we mark nodes as we travel along them
-    std::map<int32_t, bool> marks {};
-    for (auto node : node_list) {
-        // initialize all nodes as unmarked
-        marks[node.first] = false;
+    // a tree for another graph would give wrong answers
+    bool loaded
+        = max_speed_tree.load(fp, csr_node_ids.size(), topologyHash());
+    std::fclose(fp);
+    if (!loaded) {
+        return false;
     }
 
-    // mark the first node
-    marks[node_a_id] = true;
-    // and try to find a path!
-    findPathWithFlow(path, flow_used, marks, node_a_id, node_b_id);
+    max_speed_tree_version = csr_version;
+    return true;
+}
 
-    return path;
+void NetworkGraph::useMaxSpeedFile(const char* file_name) {
+    max_speed_file_name = file_name;
+    loadMaxSpeeds(file_name);
 }
 
-double NetworkGraph::getMaxSpeed(int32_t node_a_id, int32_t node_b_id) {
-    try {
-        // if the origin or destination nodes do not exist, or do not have any
-        // connections, no path exists
-        if (adjacencies.at(node_a_id).size() == 0
-            || adjacencies.at(node_b_id).size() == 0) {
+double NetworkGraph::getWidestSpeed(int32_t node_a_id, int32_t node_b_id) {
+    freeze();
+    return getWidestSpeed(node_a_id, node_b_id, shortest_paths);
+}
 
-            return -1;
-        }
-    } catch (std::out_of_range& e) {
+double NetworkGraph::getWidestSpeed(
+    int32_t node_a_id, int32_t node_b_id, ShortestPaths& paths) const {
+
+    StatTimer timer(stat_widest_speed_query);
+    TraceScope trace(
+        "widest_speed", "origin", node_a_id, "destination", node_b_id);
+
+    // if the origin or destination nodes do not exist, or do not have any
+    // connections, no path exists
+    ssize_t node_a = denseIndex(node_a_id);
+    ssize_t node_b = denseIndex(node_b_id);
+    if (!hasConnections(node_a) || !hasConnections(node_b)) {
         return -1;
     }
 
-    // the amount of bandwidth used for each edge in the network
-    std::map<Edge, int32_t> flow_used {};
-    for (auto node : node_list) {
-        for (auto edge : adjacencies[node.first]) {
-            // initialize all to zero, no bandwidth is being used
-            flow_used[edge] = 0;
-        }
+    // a path can't go back to where it started, nor leave its component
+    if (node_a == node_b || !sameComponent(node_a, node_b)) {
+        return -1;
     }
 
-    double speed = 0;
+    // if the forest is up to date, just query it
+    if (!widest_speed_tree.empty()
+        && widest_speed_tree_version == csr_version) {
+        double speed = widest_speed_tree.minFlow(
+            widest_speed_tree_indices[node_a],
+            widest_speed_tree_indices[node_b]);
 
-    // while we cannot find a possible path to give more speed to the connection
-    while (true) {
-        /*
-         * do a depth first search to find a path from node_a to node_b that
-         * still has some flow available
-         */
-        std::vector<Connection> path
-            = findPathWithFlow(flow_used, node_a_id, node_b_id);
+        // paths through the virtual root join different components
+        return speed < 0 ? -1 : speed;
+    }
+
+    paths.runWidest(csr_offsets, csr_targets, csr_speeds,
+        [](double speed) { return speed; }, node_a, node_b);
 
-        if (path.size() == 0) {
-            // if there are no more paths, there is nothing left to do: all
-            // possible flow was already used to the maximum
-            break;
+    return paths.width(node_b);
+}
+
+void NetworkGraph::precomputeWidestSpeeds() {
+    freeze();
+    TraceScope trace("widest_speed_tree", "nodes", csr_node_ids.size());
+
+    // every connection once, from the fastest to the slowest
+    std::vector<uint32_t> sorted_edges;
+    for (uint32_t node = 0; node < csr_node_ids.size(); node++) {
+        for (uint32_t edge = csr_offsets[node]; edge < csr_offsets[node + 1];
+             edge++) {
+            if (node < csr_targets[edge]) {
+                sorted_edges.push_back(edge);
+            }
         }
+    }
 
-        // the actual speed we will add is the minimum of the full path's
-        // connection speeds
-        double speed_add = std::numeric_limits<double>::infinity();
-        for (auto conn : path) {
-            speed_add = std::min(speed_add, conn.getSpeed() - flow_used[conn]);
+    std::stable_sort(sorted_edges.begin(), sorted_edges.end(),
+        [this](uint32_t edge_a, uint32_t edge_b) {
+            return csr_speeds[edge_a] > csr_speeds[edge_b];
+        });
+
+    // Kruskal's algorithm: keep every connection that joins two components
+    uint32_t num_nodes = csr_node_ids.size();
+    UnionFind components;
+    components.reset(num_nodes);
+
+    // the forest is laid out as adjacency lists, each connection in both ends
+    std::vector<std::vector<uint32_t>> forest(num_nodes);
+    for (uint32_t edge : sorted_edges) {
+        uint32_t node_a = csr_targets[csr_reverse[edge]];
+        uint32_t node_b = csr_targets[edge];
+        if (components.merge(node_a, node_b)) {
+            forest[node_a].push_back(edge);
+            forest[node_b].push_back(csr_reverse[edge]);
         }
+    }
 
-        // now, with the speed calculated, add the value to all connections
-        // used bandwidth, both for the original connection and it's reverse
-        for (auto conn : path) {
-            flow_used[conn] += speed_add;
-            conn.reverse();
-            flow_used[conn] += speed_add;
-            conn.reverse();
+    /*
+     * number the forest's nodes in BFS order after the virtual root, so that
+     * parents always come before their children as FlowTree needs
+     */
+    widest_speed_tree_indices.assign(num_nodes, 0);
+    std::vector<uint32_t> parents(1, 0);
+    std::vector<double> flows(1, 0);
+    std::vector<uint32_t> queue;
+
+    for (uint32_t root = 0; root < num_nodes; root++) {
+        if (widest_speed_tree_indices[root] != 0) {
+            continue;
         }
 
-        speed += speed_add;
+        widest_speed_tree_indices[root] = parents.size();
+        parents.push_back(0);
+        flows.push_back(-1);
+
+        queue.assign(1, root);
+        for (size_t front = 0; front < queue.size(); front++) {
+            uint32_t node = queue[front];
+            for (uint32_t edge : forest[node]) {
+                uint32_t next = csr_targets[edge];
+                if (widest_speed_tree_indices[next] != 0) {
+                    continue;
+                }
+
+                widest_speed_tree_indices[next] = parents.size();
+                parents.push_back(widest_speed_tree_indices[node]);
+                flows.push_back(csr_speeds[edge]);
+                queue.push_back(next);
+            }
+        }
     }
 
-    return speed;
+    widest_speed_tree.build(parents, flows, topologyHash());
+    widest_speed_tree_version = csr_version;
 }
 
-double NetworkGraph::getLen(std::map<int32_t, bool>& marks,
-    int32_t node_start_id, int32_t node_end_id, double max_plausable_len,
-    double min_possible_len) {
+double NetworkGraph::getLen(int32_t node_a_id, int32_t node_b_id) {
+    freeze();
+    return getLen(node_a_id, node_b_id, shortest_paths);
+}
 
-    if (min_possible_len >= max_plausable_len) {
-        /*
-         * if we already have a solution (max_plausable_len) that has a smaller
-         * distance than what we can ever hope to achieve in this recursion
-         * (min_possible_len), we can just ignore this recursion: even if we get
-         * a solution it will be worst than what we already have
-         */
-        return max_plausable_len;
-    }
+double NetworkGraph::getLen(
+    int32_t node_a_id, int32_t node_b_id, ShortestPaths& paths) const {
 
-    // for all connections in our starting node
-    for (auto connection : adjacencies[node_start_id]) {
-        // if the connected node is marked, return: we have already gone there
-        if (marks[connection.idTo()]) {
-            continue;
-        }
-        // if the connected node is our destiny
-        if (connection.idTo() == node_end_id) {
-            // get the better solution: what we already have or the new solution
-            max_plausable_len = std::min(
-                max_plausable_len, connection.getSpeed() + min_possible_len);
-            continue;
-        }
+    StatTimer timer(stat_length_query);
+    TraceScope trace("length", "origin", node_a_id, "destination", node_b_id);
+
+    // if the origin or destination nodes do not exist, or do not have any
+    // connections, no path exists
+    ssize_t node_a = denseIndex(node_a_id);
+    ssize_t node_b = denseIndex(node_b_id);
+    if (!hasConnections(node_a) || !hasConnections(node_b)) {
+        return -1;
+    }
 
-        // if the connected node is not marked and not the ending node
-        // mark it, we will go there now
-        marks[connection.idTo()] = true;
+    // a path can't go back to where it started, nor leave its component
+    if (node_a == node_b || !sameComponent(node_a, node_b)) {
+        return -1;
+    }
 
-        // recusion: start at the connected node with a new min_possible_len
-        // to include the distance from the current node to the connected one
-        max_plausable_len = getLen(marks, connection.idTo(), node_end_id,
-            max_plausable_len, min_possible_len + connection.getSpeed());
+    paths.run(csr_offsets, csr_targets, csr_speeds,
+        [](double speed) { return speed; }, node_a, node_b);
+    Stats::add(stat_length_branches_pruned, paths.numPruned());
 
-        // unmark the node: other paths might use it
-        marks[connection.idTo()] = false;
+    double len = paths.distance(node_b);
+    if (len == std::numeric_limits<double>::infinity()) {
+        return -1;
     }
 
-    // return our best solution yet
-    return max_plausable_len;
+    return len;
 }
 
-double NetworkGraph::getLen(int32_t node_a_id, int32_t node_b_id) {
-    try {
-        // if the origin or destination nodes do not exist, or do not have any
-        // connections, no path exists
-        if (adjacencies.at(node_a_id).size() == 0
-            || adjacencies.at(node_b_id).size() == 0) {
+std::vector<double> NetworkGraph::getLens(
+    int32_t source_id, const std::vector<int32_t>& node_ids) {
+    freeze();
+    return getLens(source_id, node_ids, shortest_paths);
+}
 
-            return -1;
+std::vector<double> NetworkGraph::getLens(int32_t source_id,
+    const std::vector<int32_t>& node_ids, ShortestPaths& paths) const {
+
+    StatTimer timer(stat_length_query);
+    TraceScope trace(
+        "lengths", "source", source_id, "destinations", node_ids.size());
+
+    // every length starts as invalid
+    std::vector<double> lens(node_ids.size(), -1);
+
+    // if the source does not exist or has no connections, no path exists
+    ssize_t source = denseIndex(source_id);
+    std::vector<ssize_t> nodes(node_ids.size(), EMPTY_VALUE);
+    bool any_reachable = false;
+    for (size_t i = 0; hasConnections(source) && i < node_ids.size(); i++) {
+        // the same rules as getLen apply to each node, and only nodes in the
+        // source's component can be reached
+        nodes[i] = denseIndex(node_ids[i]);
+        if (!hasConnections(nodes[i]) || nodes[i] == source
+            || !sameComponent(source, nodes[i])) {
+            nodes[i] = EMPTY_VALUE;
+        } else {
+            any_reachable = true;
         }
-    } catch (std::out_of_range& e) {
-        return -1;
     }
 
-    // all marked nodes, keeps track of recursion to prohibit infinite loops
-    std::map<int32_t, bool> marks {};
-
-    for (auto node : node_list) {
-        // initialize all nodes as unmarked
-        marks[node.first] = false;
+    if (any_reachable) {
+        // a single run without target gives the distances to all nodes
+        paths.run(csr_offsets, csr_targets, csr_speeds,
+            [](double speed) { return speed; }, source, EMPTY_VALUE);
+        Stats::add(stat_length_branches_pruned, paths.numPruned());
     }
 
-    // initialize the recursive version, starting with the first node
-    marks[node_a_id] = true;
-    double ret = getLen(marks, node_a_id, node_b_id,
-        std::numeric_limits<double>::infinity(), 0);
-    marks[node_a_id] = false;
+    for (size_t i = 0; i < node_ids.size(); i++) {
+        // every pair is traced as in getLen, inside the run shared by them
+        TraceScope pair_trace(
+            "length", "origin", source_id, "destination", node_ids[i]);
+        if (nodes[i] == EMPTY_VALUE) {
+            continue;
+        }
 
-    if (ret == std::numeric_limits<double>::infinity()) {
-        return -1;
+        double len = paths.distance(nodes[i]);
+        if (len != std::numeric_limits<double>::infinity()) {
+            lens[i] = len;
+        }
     }
 
-    return ret;
+    return lens;
 }
@@ -3,10 +3,18 @@
 
 #include <cinttypes>
 #include <map>
+#include <memory>
 #include <ostream>
 #include <string>
+#include <string_view>
 
+#include "CSRArray.hpp"
+#include "EntryView.hpp"
+#include "FlowTree.hpp"
+#include "GraphFile.hpp"
 #include "Graph.hxx"
+#include "MaxFlow.hxx"
+#include "OutputBuffer.hpp"
 #include "table.hpp"
 
 extern "C" {
@@ -16,6 +24,21 @@ extern "C" {
 #define ACRONYM_SIZE 2
 #define CONVERSION_FACTOR 1024
 
+/*
+ * the minimum amount of entries each thread scans when building a
+ * NetworkGraph in parallel, smaller tables use less threads.
+ */
+#define MIN_ENTRIES_PER_THREAD 16384
+
+/*
+ * the extension added to a graph file's name for the file that keeps the
+ * Gomory-Hu tree of its graph, see NetworkGraph::fromGraphFile.
+ */
+#define MAX_SPEED_FILE_EXTENSION ".maxspeed"
+
+// the extension of the file a tree is written to before replacing the old.
+#define MAX_SPEED_FILE_TEMPORARY ".tmp"
+
 /*
  * class NetworkNode implements interface Node. It encapsulates the nodes of
  * a computer network, i.e., the computers and points of presence in this
@@ -24,6 +47,7 @@ extern "C" {
 class NetworkNode : public Node {
     // operator<< needs to access NetworkNode's private atributes to print them.
     friend std::ostream& operator<<(std::ostream& os, const NetworkNode& node);
+    friend OutputBuffer& operator<<(OutputBuffer& ob, const NetworkNode& node);
 
 private:
     // Acronym of the country in which it's based.
@@ -32,7 +56,21 @@ private:
     std::string originCountryName; // Country in which it's based.
 
 public:
+    // getCountryAcronym returns the ACRONYM_SIZE characters of the acronym.
+    std::string_view getCountryAcronym() const;
+    const std::string& getPOPsName() const;
+    const std::string& getOriginCountryName() const;
+
     NetworkNode(entry* es); // Contructs Network Node from entry es.
+    NetworkNode(const EntryView& view); // Contructs Network Node from view.
+
+    /*
+     * Constructs a NetworkNode with address id and the given strings, where
+     * country_acronym has ACRONYM_SIZE characters. It throws a
+     * runtime_error() exception if id is empty.
+     */
+    NetworkNode(int32_t id, std::string_view country_acronym,
+        std::string_view POPs_name, std::string_view origin_country_name);
     NetworkNode() {}; // Constructs empty NetworkNode
 };
 
@@ -40,9 +78,10 @@ public:
  * operator<< overloads operator '<<' to print instance of NetworkNode 'node'
  * in ostream 'os'. It prints the address of the node, followed by its POP's
  * name, followed by its country of origin's name, and finally by its country
- * of origin's acronym.
+ * of origin's acronym. The OutputBuffer overload prints the same.
  */
 std::ostream& operator<<(std::ostream& os, const NetworkNode& node);
+OutputBuffer& operator<<(OutputBuffer& ob, const NetworkNode& node);
 
 /*
  * class Connection implements interface Edge. It is a class that encapsulates
@@ -52,22 +91,39 @@ std::ostream& operator<<(std::ostream& os, const NetworkNode& node);
 class Connection : public Edge {
     // operator<< needs to access private atributes in order to print them.
     friend std::ostream& operator<<(std::ostream& os, const Connection& conn);
+    friend OutputBuffer& operator<<(OutputBuffer& ob, const Connection& conn);
 
 private:
     double connectionSpeed; // connection speed between two network nodes.
 
+    /*
+     * toMbps converts speed, measured in unit ('K', 'M' or 'G', in any case),
+     * to megabytes per second. It throws a runtime_error() exception if the
+     * unit is invalid.
+     */
+    static double toMbps(int32_t speed, char unit);
+
 public:
-    double getSpeed();
+    double getSpeed() const;
     Connection(entry* es); // Contructs a Connection instance from entry es.
+    Connection(const EntryView& view); // Contructs a Connection from view.
+
+    /*
+     * Constructs a Connection from id_from to id_to with speed, already in
+     * megabytes per second.
+     */
+    Connection(int32_t id_from, int32_t id_to, double speed);
     Connection(); // Contructs empty Connection instance.
 };
 
 /*
  * operator<< overloads the operator '<<' to print the connection instance
  * conn in the ostream os. It prints the NetworkNode address idTo()
- * followed by the connection speed in megabytes per second.
+ * followed by the connection speed in megabytes per second. The OutputBuffer
+ * overload prints the same.
  */
 std::ostream& operator<<(std::ostream& os, const Connection& conn);
+OutputBuffer& operator<<(OutputBuffer& ob, const Connection& conn);
 
 /*
  * class NetworkGraph extends Graph<NetworkNode, Connection>. It is a
@@ -75,66 +131,237 @@ std::ostream& operator<<(std::ostream& os, const Connection& conn);
  */
 class NetworkGraph : public Graph<NetworkNode, Connection> {
     // operator<< must access protected methods in order to print them.
-    friend std::ostream& operator<<(
-        std::ostream& os, const NetworkGraph& graph);
+    friend OutputBuffer& operator<<(
+        OutputBuffer& ob, const NetworkGraph& graph);
 
 private:
     /*
-     * getLen uses a map of marked nodes in the current path, maximim plausable
-     * len (a result we already have) and a minimum possible len (the current
-     * lenght in the current path up to now) to calculate the minimum distance
-     * between a starting node and an ending node. This algorithm is made by
-     * the creators of the program, and is based on a similar method used in
-     * the discrete version of the simplex method: the branch-and-bound
-     * algorithm.
+     * graph_file is the graph file the CSR arrays view, if the graph was read
+     * from one and has not been changed since, see NetworkGraph(GraphFile).
+     */
+    std::unique_ptr<GraphFile> graph_file;
+
+    /*
+     * csr_speeds[j] is the speed of the connection csr_edges[j], which
+     * queries use as capacities and lengths. freeze rebuilds it whenever
+     * speeds_version is not the current csr_version.
+     */
+    CSRArray<double> csr_speeds;
+    uint64_t speeds_version;
+
+    /*
+     * max_flow is the engine reused by every getMaxSpeed query.
+     */
+    MaxFlow max_flow;
+
+    /*
+     * max_speed_tree is the optional Gomory-Hu tree used by getMaxSpeed, valid
+     * only if max_speed_tree_version is the current csr_version.
+     */
+    FlowTree max_speed_tree;
+    uint64_t max_speed_tree_version;
+
+    /*
+     * max_speed_file_name is the file max_speed_tree is saved to whenever
+     * precomputeMaxSpeeds builds it, empty if it is not saved.
+     */
+    std::string max_speed_file_name;
+
+    /*
+     * widest_speed_tree is the optional maximum spanning forest used by
+     * getWidestSpeed, valid only if widest_speed_tree_version is the current
+     * csr_version. Its node 0 is a virtual root from which the root of each
+     * connected component hangs with flow -1, and widest_speed_tree_indices
+     * maps each dense index to its index in the tree.
      */
-    double getLen(std::map<int32_t, bool>& marks, int32_t node_start_id,
-        int32_t node_end_id, double max_plausable_len, double min_possible_len);
+    FlowTree widest_speed_tree;
+    std::vector<uint32_t> widest_speed_tree_indices;
+    uint64_t widest_speed_tree_version;
 
     /*
-     * findPathWithFlow uses recursion to find a path from node_a to node_b
-     * that still has some flow to use, having an auxiliary map to keep track
-     * of recursions.
+     * topologyHash returns a hash of the frozen graph (nodes, connections and
+     * speeds), used to check if a saved max_speed_tree is for this graph. The
+     * hash of a graph read from a graph file is the one saved in it.
      */
-    bool findPathWithFlow(std::vector<Connection>& path,
-        std::map<Edge, int32_t>& flow_used, std::map<int32_t, bool>& marks,
-        int32_t node_a_id, int32_t node_b_id);
+    uint64_t topologyHash() const;
 
     /*
-     * findPathWithFlow initialized the recursive version of findPathWithFlow
-     * to return a full path from node_a to node_b, or an empty path if none
-     * were found.
+     * unmapGraphFile fills the node and adjacency maps of a graph read from a
+     * graph file, and copies its CSR arrays, so the graph no longer needs the
+     * file and can be changed. It does nothing for other graphs.
      */
-    std::vector<Connection> findPathWithFlow(std::map<Edge, int32_t>& flow_used,
-        int32_t node_a_id, int32_t node_b_id);
+    void unmapGraphFile();
 
 public:
     /*
-     * Constructs a NetworkGraph instance from table, which stores
-     * a network topology that can be modeled as a non-directed graph.
+     * Constructs a NetworkGraph instance from all entries of table, which
+     * stores a network topology that can be modeled as a non-directed graph.
+     * The table is scanned with one thread per available core.
      */
     NetworkGraph(const Table& table);
 
+    /*
+     * Constructs a NetworkGraph in the same way, but splitting the table's
+     * RRNs in disjoint ranges scanned by up to num_threads threads. Each
+     * thread keeps its own node and connection lists, which are merged in RRN
+     * order, so the graph is the same regardless of num_threads. The graph
+     * is frozen before returning.
+     */
+    NetworkGraph(const Table& table, uint32_t num_threads);
+
+    /*
+     * Constructs a NetworkGraph from the open graph file, frozen, which it
+     * keeps open. The CSR arrays, speeds and node strings are used in place
+     * from the file's mapping, so nothing is copied or parsed per node or
+     * edge. The node and adjacency maps stay empty (nodes are found by binary
+     * search in the file's sorted keys) until the graph is changed, see
+     * unmapGraphFile.
+     */
+    NetworkGraph(std::unique_ptr<GraphFile> file);
+
+    /*
+     * fromGraphFile returns a new NetworkGraph of table, read from the graph
+     * file named file_name if the file was built from table as it is now
+     * (see GraphFile::isFresh, and GraphFile::isValid if verify is set).
+     * Otherwise, the graph is built from table and saved to the file, so the
+     * next call can read it; failing to save it is not an error. The graph's
+     * Gomory-Hu tree is kept in the file named file_name followed by
+     * MAX_SPEED_FILE_EXTENSION, see useMaxSpeedFile.
+     */
+    static NetworkGraph* fromGraphFile(const Table& table,
+        const char* file_name, bool verify);
+
+    /*
+     * saveGraph writes the graph, built from table, to the graph file named
+     * file_name (see GraphFile), returning false if it could not be written.
+     */
+    bool saveGraph(const Table& table, const char* file_name);
+
+    /*
+     * insertNode, insertEdge and insertEdges do the same as Graph's, but a
+     * graph read from a graph file is copied out of it first, see
+     * unmapGraphFile.
+     */
+    void insertNode(const NetworkNode& new_node);
+    void insertEdge(Connection& new_edge);
+    void insertEdges(const std::vector<Connection>& new_edges);
+
+    // freeze does the same as Graph::freeze, and also builds csr_speeds.
+    void freeze();
+
     /*
      * getMaxSpeed calculates the maximum network flow that can happen between
-     * node a and node b. This implementation used the Edmonds-Karp algorithm
-     * together with a recursive graph search to find possible paths
-     * from a to b.
+     * node a and node b, using connection speeds as capacities, or -1 if any
+     * of them has no connections. This implementation uses Dinic's algorithm,
+     * see MaxFlow.
      */
     double getMaxSpeed(int32_t node_a_id, int32_t node_b_id);
 
     /*
-     * getLen calculates the minimum distance between nodes a and b.
-     * The method initializes a map to keep track of recursions and calls the
-     * private version of getLen().
+     * getMaxSpeed does the same as the overload above, but the engine is
+     * given instead of the graph's own, and the graph must already be frozen.
+     * Since it changes nothing in the graph, any number of threads may call
+     * it at the same time, each with its own flows engine.
+     */
+    double getMaxSpeed(
+        int32_t node_a_id, int32_t node_b_id, MaxFlow& flows) const;
+
+    /*
+     * precomputeMaxSpeeds builds a Gomory-Hu tree of the graph with one
+     * maximum flow computation per node (Gusfield's algorithm), unless the
+     * tree is already built (or loaded) for the graph as it is. Until the
+     * graph changes, getMaxSpeed answers from the tree in O(log n).
+     */
+    void precomputeMaxSpeeds();
+
+    /*
+     * saveMaxSpeeds writes the tree built by precomputeMaxSpeeds (which is
+     * called if needed) to the file named file_name, returning false if the
+     * file could not be written.
+     */
+    bool saveMaxSpeeds(const char* file_name);
+
+    /*
+     * loadMaxSpeeds reads a tree written by saveMaxSpeeds from the file named
+     * file_name, to be used by getMaxSpeed. It returns false (and the tree is
+     * not used) if the file could not be read or it was saved for a
+     * different graph.
+     */
+    bool loadMaxSpeeds(const char* file_name);
+
+    /*
+     * useMaxSpeedFile loads the tree saved in the file named file_name, if
+     * it was saved for this graph (see loadMaxSpeeds), and makes every later
+     * precomputeMaxSpeeds save the tree it builds to that file.
+     */
+    void useMaxSpeedFile(const char* file_name);
+
+    /*
+     * getWidestSpeed calculates the speed of the fastest single path between
+     * nodes a and b, i.e., the largest speed of the slowest connection in a
+     * path, or -1 if there is no path (as in getLen, a node never has a path
+     * to itself). It runs a modified Dijkstra's algorithm, see
+     * ShortestPaths::runWidest.
+     */
+    double getWidestSpeed(int32_t node_a_id, int32_t node_b_id);
+
+    /*
+     * getWidestSpeed does the same with the given engine, in the same way as
+     * the const getMaxSpeed.
+     */
+    double getWidestSpeed(
+        int32_t node_a_id, int32_t node_b_id, ShortestPaths& paths) const;
+
+    /*
+     * precomputeWidestSpeeds builds a maximum spanning forest of the graph
+     * with Kruskal's algorithm. The widest path between two nodes is the path
+     * between them in the forest, so until the graph changes, getWidestSpeed
+     * answers from it in O(log n).
+     */
+    void precomputeWidestSpeeds();
+
+    /*
+     * getLen calculates the minimum distance between nodes a and b, using
+     * connection speeds as lengths, or -1 if there is no path (a node is
+     * never considered to have a path to itself). It runs Dijkstra's
+     * algorithm, see ShortestPaths.
      */
     double getLen(int32_t node_a_id, int32_t node_b_id);
+
+    /*
+     * getLen does the same with the given engine, in the same way as the
+     * const getMaxSpeed.
+     */
+    double getLen(
+        int32_t node_a_id, int32_t node_b_id, ShortestPaths& paths) const;
+
+    /*
+     * getLens returns, for each node in node_ids, the same as
+     * getLen(source_id, node), but with a single shortest path computation
+     * from source_id for all of them. Since the graph is non-directed, it is
+     * also the length from each node to source_id.
+     */
+    std::vector<double> getLens(
+        int32_t source_id, const std::vector<int32_t>& node_ids);
+
+    /*
+     * getLens does the same with the given engine, in the same way as the
+     * const getMaxSpeed.
+     */
+    std::vector<double> getLens(int32_t source_id,
+        const std::vector<int32_t>& node_ids, ShortestPaths& paths) const;
 };
 
 /*
- * operator<< overloads the operator '<<' to print NetworkGraphs in ostreams.
- * For each NetworkNode Ni and each Connection Ej adjacent to it, it prints
- * the Network followed by the edge, then goes to the next line.
+ * operator<< overloads the operator '<<' to print NetworkGraphs in
+ * OutputBuffers. For each NetworkNode Ni and each Connection Ej adjacent to
+ * it, it prints the Network followed by the edge, then goes to the next line.
+ */
+OutputBuffer& operator<<(OutputBuffer& ob, const NetworkGraph& graph);
+
+/*
+ * operator<< prints graph in the ostream os in the same way, through an
+ * OutputBuffer, so os is written in large blocks and never flushed.
  */
 std::ostream& operator<<(std::ostream& os, const NetworkGraph& graph);
 
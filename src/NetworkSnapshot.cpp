@@ -0,0 +1,55 @@
+#include <thread>
+#include <utility>
+
+#include "NetworkSnapshot.hpp"
+
+NetworkSnapshot::NetworkSnapshot(NetworkGraph graph) : graph(std::move(graph)) {
+    this->graph.freeze();
+}
+
+const NetworkGraph& NetworkSnapshot::getGraph() const { return graph; }
+
+void SnapshotCell::publish(std::unique_ptr<const NetworkSnapshot> snapshot) {
+    std::lock_guard<std::mutex> lock(publish_mutex);
+    uint64_t next_generation = generation + 1;
+    uint32_t slot = next_generation % 2;
+
+    // the readers left in the slot pinned it before the last publish
+    while (readers[slot] != 0) {
+        std::this_thread::yield();
+    }
+
+    snapshots[slot] = std::move(snapshot);
+    generation = next_generation;
+}
+
+bool SnapshotCell::isEmpty() const { return generation == 0; }
+
+SnapshotCell::SnapshotCell() {
+    generation = 0;
+    readers[0] = 0;
+    readers[1] = 0;
+}
+
+const NetworkSnapshot* SnapshotReader::get() const {
+    return cell.snapshots[slot].get();
+}
+
+SnapshotReader::SnapshotReader(SnapshotCell& cell) : cell(cell) {
+    /*
+     * the slot is pinned once the generation is the same after counting in
+     * it, since a writer only replaces the slot of the generation before the
+     * current one
+     */
+    while (true) {
+        uint64_t generation = cell.generation;
+        slot = generation % 2;
+        cell.readers[slot]++;
+        if (cell.generation == generation) {
+            break;
+        }
+        cell.readers[slot]--;
+    }
+}
+
+SnapshotReader::~SnapshotReader() { cell.readers[slot]--; }
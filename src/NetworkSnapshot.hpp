@@ -0,0 +1,97 @@
+#ifndef __NETWORK_SNAPSHOT_HPP__
+#define __NETWORK_SNAPSHOT_HPP__
+
+#include <atomic>
+#include <cinttypes>
+#include <memory>
+#include <mutex>
+
+#include "NetworkGraph.hpp"
+
+/*
+ * class NetworkSnapshot is an immutable, frozen NetworkGraph. Only the
+ * graph's const methods can be called through it, which read the graph
+ * without changing anything in it (the scratch state of each query is the
+ * engine given to it), so any number of threads can share a snapshot without
+ * locks, as long as each one uses its own engines.
+ *
+ * Trees precomputed in the graph before the snapshot is taken (see
+ * NetworkGraph::precomputeMaxSpeeds) are kept, and used by its queries.
+ */
+class NetworkSnapshot {
+private:
+    NetworkGraph graph; // the frozen graph, never changed after construction.
+
+public:
+    /*
+     * Constructs a snapshot of graph, which is frozen if needed. The graph
+     * can be moved in, avoiding the copy.
+     */
+    NetworkSnapshot(NetworkGraph graph);
+
+    // getGraph returns the frozen graph, for its const queries.
+    const NetworkGraph& getGraph() const;
+};
+
+/*
+ * class SnapshotCell holds the current NetworkSnapshot of a network that may
+ * change, in the same way as read-copy-update (RCU): readers pin the current
+ * snapshot (see SnapshotReader) and keep using it for as long as they need,
+ * while a writer builds a new snapshot aside and publishes it, so readers
+ * never wait for writers nor see a half-updated graph.
+ *
+ * Snapshots are kept in two slots, used by alternate generations: the
+ * current snapshot is in slot generation % 2 and the previous one in the
+ * other. Readers pin a slot by counting themselves in it, without any lock.
+ * Publishing replaces the previous snapshot, so the writer first waits for
+ * the readers still pinning it, which started before the last publish.
+ */
+class SnapshotCell {
+    friend class SnapshotReader;
+
+private:
+    std::atomic<uint64_t> generation; // the number of snapshots published.
+    std::atomic<uint32_t> readers[2]; // the readers pinning each slot.
+    std::unique_ptr<const NetworkSnapshot> snapshots[2];
+    std::mutex publish_mutex; // held by the writer publishing, if any.
+
+public:
+    /*
+     * publish makes snapshot the current one, freeing the one before the
+     * current, after waiting for its readers. Writers may publish at the same
+     * time, one after the other.
+     */
+    void publish(std::unique_ptr<const NetworkSnapshot> snapshot);
+
+    // isEmpty returns whether no snapshot was published yet.
+    bool isEmpty() const;
+
+    SnapshotCell(); // Constructs a cell with no snapshot published.
+
+    SnapshotCell(const SnapshotCell&) = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+};
+
+/*
+ * class SnapshotReader pins the current snapshot of a SnapshotCell while it
+ * exists, so the snapshot is not freed even if a newer one is published. A
+ * writer publishing twice waits for the readers of the first snapshot, so
+ * readers are meant to last for a single request.
+ */
+class SnapshotReader {
+private:
+    SnapshotCell& cell;
+    uint32_t slot; // the slot pinned.
+
+public:
+    // get returns the pinned snapshot, NULL if nothing was published yet.
+    const NetworkSnapshot* get() const;
+
+    SnapshotReader(SnapshotCell& cell); // Pins cell's current snapshot.
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#include <algorithm>
+
+#include "NodeMarks.hpp"
+
+void NodeMarks::clear(size_t num_nodes) {
+    if (stamps.size() < num_nodes) {
+        stamps.resize(num_nodes, 0);
+    }
+
+    epoch++;
+    if (epoch == 0) {
+        // the epoch overflowed, so old stamps could look marked again
+        std::fill(stamps.begin(), stamps.end(), 0);
+        epoch = 1;
+    }
+}
+
+bool NodeMarks::isMarked(uint32_t node_index) const {
+    return stamps[node_index] == epoch;
+}
+
+void NodeMarks::mark(uint32_t node_index) { stamps[node_index] = epoch; }
+
+void NodeMarks::unmark(uint32_t node_index) { stamps[node_index] = 0; }
+
+NodeMarks::NodeMarks() { epoch = 0; }
@@ -0,0 +1,33 @@
+#ifndef __NODE_MARKS_HPP__
+#define __NODE_MARKS_HPP__
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+/*
+ * class NodeMarks is a set of marked nodes, given by their dense indices (see
+ * Graph), that is meant to be reused between queries. Each node has a stamp,
+ * and a node is marked iff its stamp is the current epoch, so clearing all
+ * marks is just starting a new epoch instead of touching every node.
+ */
+class NodeMarks {
+private:
+    std::vector<uint32_t> stamps; // the epoch in which each node was marked.
+    uint32_t epoch; // the current epoch, never 0 (0 means never marked).
+
+public:
+    /*
+     * clear unmarks every node and makes room for num_nodes nodes. It is O(1)
+     * unless the number of nodes grows or the epoch overflows.
+     */
+    void clear(size_t num_nodes);
+
+    bool isMarked(uint32_t node_index) const; // whether the node is marked.
+    void mark(uint32_t node_index); // mark marks the node.
+    void unmark(uint32_t node_index); // unmark unmarks the node.
+
+    NodeMarks(); // Constructs an empty set of marks.
+};
+
+#endif
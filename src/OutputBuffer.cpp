@@ -0,0 +1,68 @@
+#include <charconv>
+#include <cstring>
+
+#include "OutputBuffer.hpp"
+
+void OutputBuffer::reserve(size_t size) {
+    if (used + size > buffer.size()) {
+        flush();
+    }
+}
+
+OutputBuffer& OutputBuffer::operator<<(std::string_view text) {
+    // text larger than the buffer is written straight to the stream
+    if (text.size() > buffer.size()) {
+        flush();
+        out.write(text.data(), text.size());
+        return *this;
+    }
+
+    reserve(text.size());
+    std::memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(char character) {
+    reserve(1);
+    buffer[used++] = character;
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(int32_t number) {
+    reserve(OUTPUT_NUMBER_SIZE);
+    char* start = buffer.data() + used;
+    used = std::to_chars(start, start + OUTPUT_NUMBER_SIZE, number).ptr
+        - buffer.data();
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(int64_t number) {
+    reserve(OUTPUT_NUMBER_SIZE);
+    char* start = buffer.data() + used;
+    used = std::to_chars(start, start + OUTPUT_NUMBER_SIZE, number).ptr
+        - buffer.data();
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(double number) {
+    reserve(OUTPUT_NUMBER_SIZE);
+    char* start = buffer.data() + used;
+    used = std::to_chars(start, start + OUTPUT_NUMBER_SIZE, number,
+               std::chars_format::general, OUTPUT_DOUBLE_PRECISION)
+               .ptr
+        - buffer.data();
+    return *this;
+}
+
+void OutputBuffer::flush() {
+    if (used > 0) {
+        out.write(buffer.data(), used);
+        used = 0;
+    }
+}
+
+OutputBuffer::OutputBuffer(std::ostream& out)
+    : out(out), buffer(OUTPUT_BUFFER_SIZE), used(0) { }
+
+OutputBuffer::~OutputBuffer() { flush(); }
@@ -0,0 +1,55 @@
+#ifndef __OUTPUT_BUFFER_HPP__
+#define __OUTPUT_BUFFER_HPP__
+
+#include <cinttypes>
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// how many bytes an OutputBuffer holds before writing them to its stream.
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+// the most characters a number written to an OutputBuffer can take.
+#define OUTPUT_NUMBER_SIZE 32
+
+/*
+ * the significant digits of doubles written to an OutputBuffer, the same as
+ * the default precision of ostreams, so both write the same characters.
+ */
+#define OUTPUT_DOUBLE_PRECISION 6
+
+/*
+ * class OutputBuffer gathers text to be written to an ostream in a large
+ * buffer, which is written with a single call only when it fills up or the
+ * OutputBuffer is flushed or destroyed. Numbers are formatted with
+ * std::to_chars, without locales or stream state. The stream itself is
+ * never flushed, so "\n" ends lines instead of std::endl.
+ */
+class OutputBuffer {
+private:
+    std::ostream& out; // the stream the text goes to.
+    std::vector<char> buffer;
+    size_t used; // how many bytes of buffer hold text.
+
+    // reserve makes room for size more bytes, writing the buffer if needed.
+    void reserve(size_t size);
+
+public:
+    OutputBuffer& operator<<(std::string_view text);
+    OutputBuffer& operator<<(char character);
+    OutputBuffer& operator<<(int32_t number);
+    OutputBuffer& operator<<(int64_t number);
+    OutputBuffer& operator<<(double number);
+
+    // flush writes the buffered text to the stream, without flushing it.
+    void flush();
+
+    OutputBuffer(std::ostream& out); // Constructs an empty buffer for out.
+    ~OutputBuffer(); // Flushes the buffer.
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+};
+
+#endif
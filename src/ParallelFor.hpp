@@ -0,0 +1,18 @@
+#ifndef __PARALLEL_FOR_HPP__
+#define __PARALLEL_FOR_HPP__
+
+#include <cinttypes>
+#include <cstddef>
+
+/*
+ * parallelFor calls work(thread, item) for every item from 0 to num_items - 1
+ * with up to num_threads threads (the calling one included), where thread,
+ * from 0 to num_threads - 1, identifies the thread running it, so each thread
+ * can have its own state. Items are handed out one at a time in increasing
+ * order, so threads stay balanced even if items take very different times.
+ * It returns after every item is done.
+ */
+template <class Work>
+void parallelFor(size_t num_items, uint32_t num_threads, Work work);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef __PARALLEL_FOR_HXX__
+#define __PARALLEL_FOR_HXX__
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ParallelFor.hpp"
+
+template <class Work>
+void parallelFor(size_t num_items, uint32_t num_threads, Work work) {
+    // there is no point in threads without items
+    num_threads = std::max<size_t>(1, std::min<size_t>(num_threads, num_items));
+
+    std::atomic<size_t> next_item(0);
+    auto run = [&](uint32_t thread) {
+        for (size_t item = next_item++; item < num_items; item = next_item++) {
+            work(thread, item);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 1; thread < num_threads; thread++) {
+        threads.push_back(std::thread(run, thread));
+    }
+
+    // the current thread works as the first one
+    run(0);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+#endif
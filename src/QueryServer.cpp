@@ -0,0 +1,378 @@
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "QueryServer.hpp"
+#include "commands.hpp"
+#include "table.hpp"
+
+/*
+ * isValidTable returns whether the file named table_name is a table with a
+ * whole, consistent header page, since Table ends the program if it can't
+ * open the file or its header is not consistent, and reads the rest of the
+ * header without checking it.
+ */
+static bool isValidTable(const std::string& table_name) {
+    struct stat file_stat;
+    if (stat(table_name.c_str(), &file_stat) != 0
+        || !S_ISREG(file_stat.st_mode) || file_stat.st_size < PAGE_SIZE) {
+        return false;
+    }
+
+    FILE* fp = std::fopen(table_name.c_str(), "rb");
+    if (fp == NULL) {
+        return false;
+    }
+
+    char header_page[HEADER_SIZE];
+    bool read = std::fread(header_page, HEADER_SIZE, 1, fp) == 1;
+    std::fclose(fp);
+    return read && header_page[0] == OK_HEADER;
+}
+
+/*
+ * statTable stores the size of the file named table_name and its
+ * modification time, in nanoseconds, returning false if it can't be read.
+ */
+static bool statTable(
+    const std::string& table_name, uint64_t& size, int64_t& modified) {
+    struct stat file_stat;
+    if (stat(table_name.c_str(), &file_stat) != 0) {
+        return false;
+    }
+
+    size = file_stat.st_size;
+    modified = (int64_t)file_stat.st_mtim.tv_sec * 1000000000
+        + file_stat.st_mtim.tv_nsec;
+    return true;
+}
+
+/*
+ * stopping is set when the server gets SIGINT or SIGTERM, see stopServing.
+ * waited_fd is the file descriptor the server waits for input on, or -1, and
+ * waited_is_socket is whether it is a listening socket.
+ */
+static volatile std::sig_atomic_t stopping = 0;
+static volatile std::sig_atomic_t waited_fd = -1;
+static volatile std::sig_atomic_t waited_is_socket = 0;
+
+/*
+ * stopServing handles SIGINT and SIGTERM: it sets stopping and ends the
+ * input the server waits on, so a blocked accept or read returns instead of
+ * waiting for another client or request. A socket is shut down, and any
+ * other file descriptor is replaced by /dev/null, which reads as ended.
+ */
+static void stopServing(int) {
+    stopping = 1;
+
+    int fd = waited_fd;
+    if (fd == -1) {
+        return;
+    }
+
+    if (waited_is_socket) {
+        shutdown(fd, SHUT_RDWR);
+        return;
+    }
+
+    int null_fd = open("/dev/null", O_RDONLY);
+    if (null_fd != -1) {
+        dup2(null_fd, fd);
+        close(null_fd);
+    }
+}
+
+/*
+ * waitOn makes fd the input stopServing ends, and handles SIGINT and SIGTERM
+ * with it, without restarting interrupted calls.
+ */
+static void waitOn(int fd, bool is_socket) {
+    waited_is_socket = is_socket;
+    waited_fd = fd;
+
+    struct sigaction action = {};
+    action.sa_handler = stopServing;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+}
+
+/*
+ * handleAcceptError handles accept failing with errno, returning whether the
+ * server should keep accepting. Interrupted calls and connections that went
+ * away are retried, running out of file descriptors or memory is retried
+ * after ACCEPT_RETRY_DELAY_US, and any other error stops the server.
+ */
+static bool handleAcceptError() {
+    switch (errno) {
+    case EINTR:
+    case ECONNABORTED:
+    case EPROTO:
+        return true;
+    case EMFILE:
+    case ENFILE:
+    case ENOBUFS:
+    case ENOMEM:
+        std::perror("accept");
+        usleep(ACCEPT_RETRY_DELAY_US);
+        return true;
+    default:
+        // the socket is shut down on purpose when the server stops
+        if (!stopping) {
+            std::perror("accept");
+        }
+        return false;
+    }
+}
+
+// isBlank returns whether line only has whitespace.
+static bool isBlank(const std::string& line) {
+    return line.find_first_not_of(" \t\r\v\f") == std::string::npos;
+}
+
+bool QueryServer::load(const std::string& table_name) {
+    return getTable(table_name) != NULL;
+}
+
+QueryServer::ServedTable* QueryServer::getTable(
+    const std::string& table_name) {
+    ServedTable* table;
+    {
+        std::lock_guard<std::mutex> lock(tables_mutex);
+        auto table_it = tables.find(table_name);
+        if (table_it != tables.end()) {
+            table = table_it->second.get();
+        } else if (isValidTable(table_name)) {
+            table = new ServedTable();
+            table->table_size = 0;
+            table->table_modified = 0;
+            tables[table_name] = std::unique_ptr<ServedTable>(table);
+        } else {
+            return NULL;
+        }
+    }
+
+    if (table->snapshots.isEmpty()) {
+        // nothing to answer from yet, so wait for the first build
+        std::lock_guard<std::mutex> lock(table->rebuild_mutex);
+        rebuildTable(table_name, *table);
+        return table->snapshots.isEmpty() ? NULL : table;
+    }
+
+    uint64_t size;
+    int64_t modified;
+    if (!statTable(table_name, size, modified)
+        || (size == table->table_size && modified == table->table_modified)) {
+        return table;
+    }
+
+    // a request already rebuilding it publishes the new snapshot later
+    std::unique_lock<std::mutex> lock(table->rebuild_mutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+        rebuildTable(table_name, *table);
+    }
+    return table;
+}
+
+void QueryServer::rebuildTable(
+    const std::string& table_name, ServedTable& table) {
+    // the file is checked before reading it, so a change while it is read is
+    // found by the next request
+    uint64_t size;
+    int64_t modified;
+    if (!statTable(table_name, size, modified)
+        || (!table.snapshots.isEmpty() && size == table.table_size
+            && modified == table.table_modified)
+        || !isValidTable(table_name)) {
+        return;
+    }
+
+    // the graph does not need the table after it is built
+    std::vector<char> name(table_name.begin(), table_name.end());
+    name.push_back('\0');
+    Table topology(name.data(), "rb");
+
+    std::unique_ptr<NetworkGraph> graph(use_graph_files
+            ? NetworkGraph::fromGraphFile(topology,
+                (table_name + GRAPH_FILE_EXTENSION).c_str(),
+                verify_graph_files)
+            : new NetworkGraph(topology));
+
+    // snapshots are never changed, so the forest is built beforehand
+    graph->precomputeWidestSpeeds();
+    table.snapshots.publish(std::unique_ptr<const NetworkSnapshot>(
+        new NetworkSnapshot(std::move(*graph))));
+    table.table_size = size;
+    table.table_modified = modified;
+}
+
+bool QueryServer::readRequest(InputBuffer& in, std::string& request) {
+    request.clear();
+
+    std::string line;
+    while (in.readLine(line)) {
+        if (!isBlank(line)) {
+            request += line;
+            request += '\n';
+        } else if (!request.empty()) {
+            return true;
+        }
+    }
+
+    return !request.empty();
+}
+
+bool QueryServer::answer(InputBuffer& in, std::ostream& out) {
+    std::string request;
+    if (!readRequest(in, request)) {
+        return false;
+    }
+
+    // the command only sees its own request, whatever it leaves unread
+    InputBuffer request_in(request);
+    int32_t command;
+    std::string table_name;
+    ServedTable* table = NULL;
+    if (request_in.read(command) && request_in.read(table_name)) {
+        table = getTable(table_name);
+    }
+
+    if (table == NULL) {
+        out << REQUEST_ERROR_MESSAGE << std::endl;
+        return true;
+    }
+
+    // the snapshot stays valid until the answer is written
+    SnapshotReader reader(table->snapshots);
+    if (!runCommand(command, *reader.get(), request_in, out)) {
+        out << REQUEST_ERROR_MESSAGE << std::endl;
+    }
+
+    return true;
+}
+
+void QueryServer::serveStream(InputBuffer& in, std::ostream& out) {
+    while (answer(in, out)) {
+        out.flush();
+    }
+}
+
+void QueryServer::serveFile(int fd, std::ostream& out) {
+    waitOn(fd, false);
+    InputBuffer in(fd);
+    serveStream(in, out);
+}
+
+bool QueryServer::serveSocket(const char* socket_path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (std::snprintf(address.sun_path, sizeof(address.sun_path), "%s",
+            socket_path)
+        >= (int)sizeof(address.sun_path)) {
+        return false; // the path does not fit in the address.
+    }
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server == -1) {
+        return false;
+    }
+
+    unlink(socket_path);
+    if (bind(server, (sockaddr*)&address, sizeof(address)) == -1
+        || listen(server, SOMAXCONN) == -1) {
+        close(server);
+        return false;
+    }
+
+    waitOn(server, true);
+    bool failed = false;
+    while (!stopping) {
+        int client = accept(server, NULL, NULL);
+        if (client == -1) {
+            if (handleAcceptError()) {
+                continue;
+            }
+
+            failed = !stopping;
+            break;
+        }
+
+        // the connection's thread leaves the signals to this one
+        sigset_t signals;
+        sigset_t previous_signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, &previous_signals);
+        {
+            std::unique_lock<std::mutex> lock(connections_mutex);
+            connection_done.wait(lock,
+                [&]() { return num_connections < MAX_CONNECTION_THREADS; });
+            num_connections++;
+        }
+        std::thread(&QueryServer::serveConnection, this, client).detach();
+        pthread_sigmask(SIG_SETMASK, &previous_signals, NULL);
+    }
+
+    // the connections being answered still use the server
+    {
+        std::unique_lock<std::mutex> lock(connections_mutex);
+        connection_done.wait(lock, [&]() { return num_connections == 0; });
+    }
+
+    close(server);
+    unlink(socket_path);
+    return !failed;
+}
+
+void QueryServer::serveConnection(int client) {
+    // read every request before answering them, even if a signal comes
+    std::string requests;
+    char buffer[4096];
+    ssize_t received;
+    while ((received = recv(client, buffer, sizeof(buffer), 0)) != 0) {
+        if (received > 0) {
+            requests.append(buffer, received);
+        } else if (errno != EINTR) {
+            break;
+        }
+    }
+
+    InputBuffer in(requests);
+    std::ostringstream out;
+    serveStream(in, out);
+
+    // a client that went away just misses its answers
+    std::string answers = out.str();
+    size_t sent = 0;
+    while (sent < answers.size()) {
+        ssize_t written = send(client, answers.data() + sent,
+            answers.size() - sent, MSG_NOSIGNAL);
+        if (written == -1 && errno == EINTR) {
+            continue;
+        } else if (written <= 0) {
+            break;
+        }
+        sent += written;
+    }
+
+    close(client);
+
+    std::lock_guard<std::mutex> lock(connections_mutex);
+    num_connections--;
+    connection_done.notify_all();
+}
+
+QueryServer::QueryServer(bool use_graph_files, bool verify_graph_files) {
+    num_connections = 0;
+    this->use_graph_files = use_graph_files;
+    this->verify_graph_files = verify_graph_files;
+}
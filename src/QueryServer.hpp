@@ -0,0 +1,161 @@
+#ifndef __QUERY_SERVER_HPP__
+#define __QUERY_SERVER_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "InputBuffer.hpp"
+#include "NetworkGraph.hpp"
+#include "NetworkSnapshot.hpp"
+
+// the message written when a request can't be answered.
+#define REQUEST_ERROR_MESSAGE "Falha na execução da funcionalidade."
+
+/*
+ * how long serveSocket waits before accepting again when it runs out of file
+ * descriptors or memory, in microseconds.
+ */
+#define ACCEPT_RETRY_DELAY_US 100000
+
+// how many connections serveSocket answers at the same time, at most.
+#define MAX_CONNECTION_THREADS 64
+
+/*
+ * class QueryServer keeps the NetworkGraphs of one or more tables loaded, so
+ * a stream of commands can be answered without rebuilding them each time.
+ *
+ * Requests have the same format as the program's input: a command number and
+ * a table name, followed by the command's own input. Each request ends at a
+ * blank line (or at the end of the input), so a request that can't be
+ * answered is skipped whole, and its input is never read as the next
+ * request. A table is loaded the first time a request names it (or when
+ * load is called), and it is kept until the server ends.
+ *
+ * Requests are answered from a NetworkSnapshot of each table, so any number
+ * of them can be answered at the same time. When a request finds that its
+ * table changed since its snapshot was built (its size or modification time
+ * differ), it builds a new snapshot and publishes it, while the requests
+ * that come meanwhile are still answered from the old one. A table that is
+ * no longer valid (e.g. while it is being written) keeps its old snapshot.
+ * Each request sees a single snapshot, but the requests of a connection may
+ * see different ones.
+ */
+class QueryServer {
+private:
+    /*
+     * struct ServedTable is a loaded table: the cell with its current
+     * snapshot, and the size and modification time (in nanoseconds) the table
+     * file had when that snapshot was built. Only the holder of
+     * rebuild_mutex builds and publishes snapshots.
+     */
+    struct ServedTable {
+        SnapshotCell snapshots;
+        std::mutex rebuild_mutex;
+        std::atomic<uint64_t> table_size;
+        std::atomic<int64_t> table_modified;
+    };
+
+    // tables maps each loaded table's name to it, guarded by tables_mutex.
+    std::map<std::string, std::unique_ptr<ServedTable>> tables;
+    std::mutex tables_mutex;
+
+    /*
+     * the number of connections serveSocket is answering, guarded by
+     * connections_mutex, and notified in connection_done when one ends.
+     */
+    uint32_t num_connections;
+    std::mutex connections_mutex;
+    std::condition_variable connection_done;
+
+    /*
+     * whether graphs are read from and saved to graph files, and whether
+     * those files are checked in full, see load.
+     */
+    bool use_graph_files;
+    bool verify_graph_files;
+
+    /*
+     * getTable returns the table named table_name, loading it if needed, or
+     * NULL if it is not a valid table and was never loaded. If the table
+     * changed, a new snapshot is built first, unless another request is
+     * already building one.
+     */
+    ServedTable* getTable(const std::string& table_name);
+
+    /*
+     * rebuildTable builds a snapshot of the table named table_name and
+     * publishes it in table, unless the table did not change since its
+     * current snapshot or is not valid. The caller must hold rebuild_mutex.
+     */
+    void rebuildTable(const std::string& table_name, ServedTable& table);
+
+    /*
+     * readRequest reads the lines of the next request from in into request,
+     * skipping blank lines before it, returning false if there are no more
+     * requests.
+     */
+    static bool readRequest(InputBuffer& in, std::string& request);
+
+    /*
+     * answer reads one request from in and writes its answer to out. If the
+     * table or the command number are invalid, REQUEST_ERROR_MESSAGE is
+     * written instead. It returns false if there were no more requests.
+     */
+    bool answer(InputBuffer& in, std::ostream& out);
+
+    /*
+     * serveConnection receives the requests of the connected socket client,
+     * sends their answers back and closes it, see serveSocket.
+     */
+    void serveConnection(int client);
+
+public:
+    /*
+     * load loads the table named table_name, returning false if it is not a
+     * valid table. If graph files are used, its graph is read from the graph
+     * file named table_name followed by GRAPH_FILE_EXTENSION while that file
+     * is fresh (and, if verify_graph_files is set, valid), see
+     * NetworkGraph::fromGraphFile.
+     */
+    bool load(const std::string& table_name);
+
+    /*
+     * serveStream answers every request in in until it ends, writing the
+     * answers to out and flushing them after each request.
+     */
+    void serveStream(InputBuffer& in, std::ostream& out);
+
+    /*
+     * serveFile answers the requests read from fd as serveStream does, and
+     * makes SIGINT and SIGTERM end fd, so the requests already read are
+     * answered and then the program can exit normally (and run its atexit
+     * handlers, see Stats and Trace).
+     */
+    void serveFile(int fd, std::ostream& out);
+
+    /*
+     * serveSocket listens in a Unix domain socket at socket_path (replacing
+     * any file there) and answers each connection in its own thread, up to
+     * MAX_CONNECTION_THREADS at the same time, until the server gets SIGINT
+     * or SIGTERM. Each connection sends its requests and shuts down its
+     * writing side, and then receives all answers before the server closes
+     * it. The connections being answered when the signal comes are finished
+     * first, and then the socket is removed and true is returned.
+     * It returns false if the socket could not be created, or if accepting
+     * connections failed for good (see handleAcceptError).
+     */
+    bool serveSocket(const char* socket_path);
+
+    /*
+     * Constructs a QueryServer with no tables loaded, see use_graph_files and
+     * verify_graph_files.
+     */
+    QueryServer(bool use_graph_files, bool verify_graph_files);
+};
+
+#endif
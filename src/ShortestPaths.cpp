@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+#include "ShortestPaths.hpp"
+
+uint32_t RadixHeap::bucketIndex(uint64_t key) const {
+    if (key == last) {
+        return 0;
+    }
+
+    // one more than the highest bit in which key and last differ
+    return 64 - __builtin_clzll(key ^ last);
+}
+
+bool RadixHeap::empty() const { return size == 0; }
+
+void RadixHeap::push(uint64_t key, uint32_t node) {
+    buckets[bucketIndex(key)].push_back(std::make_pair(key, node));
+    size++;
+}
+
+std::pair<uint64_t, uint32_t> RadixHeap::pop() {
+    if (buckets[0].empty()) {
+        // find the first non-empty bucket and its smallest key
+        uint32_t index = 1;
+        while (buckets[index].empty()) {
+            index++;
+        }
+
+        last = std::min_element(buckets[index].begin(), buckets[index].end())
+                   ->first;
+
+        // all keys of the bucket now differ from last in lower bits
+        for (auto& key : buckets[index]) {
+            buckets[bucketIndex(key.first)].push_back(key);
+        }
+        buckets[index].clear();
+    }
+
+    std::pair<uint64_t, uint32_t> top = buckets[0].back();
+    buckets[0].pop_back();
+    size--;
+
+    return top;
+}
+
+void RadixHeap::clear() {
+    for (auto& bucket : buckets) {
+        bucket.clear();
+    }
+
+    last = 0;
+    size = 0;
+}
+
+RadixHeap::RadixHeap() {
+    last = 0;
+    size = 0;
+}
+
+/*
+ * distanceKey maps a non-negative distance to an integer key with the same
+ * order: the bits of non-negative doubles are ordered as unsigned integers.
+ */
+static uint64_t distanceKey(double distance) {
+    uint64_t key;
+    std::memcpy(&key, &distance, sizeof(double));
+    return key;
+}
+
+// keyDistance is the inverse of distanceKey.
+static double keyDistance(uint64_t key) {
+    double distance;
+    std::memcpy(&distance, &key, sizeof(double));
+    return distance;
+}
+
+void ShortestPaths::push(double distance, uint32_t node) {
+    if (run_heap_type == radix_heap) {
+        radix.push(distanceKey(distance), node);
+        return;
+    }
+
+    binary.push_back(std::make_pair(distance, node));
+    std::push_heap(binary.begin(), binary.end(),
+        std::greater<std::pair<double, uint32_t>>());
+}
+
+std::pair<double, uint32_t> ShortestPaths::pop() {
+    if (run_heap_type == radix_heap) {
+        std::pair<uint64_t, uint32_t> top = radix.pop();
+        return std::make_pair(keyDistance(top.first), top.second);
+    }
+
+    std::pop_heap(binary.begin(), binary.end(),
+        std::greater<std::pair<double, uint32_t>>());
+    std::pair<double, uint32_t> top = binary.back();
+    binary.pop_back();
+
+    return top;
+}
+
+bool ShortestPaths::empty() const {
+    if (run_heap_type == radix_heap) {
+        return radix.empty();
+    }
+
+    return binary.empty();
+}
+
+void ShortestPaths::clear(size_t num_nodes) {
+    if (distances.size() < num_nodes) {
+        distances.resize(num_nodes);
+    }
+
+    reached.clear(num_nodes);
+    settled.clear(num_nodes);
+    binary.clear();
+    radix.clear();
+    num_pruned = 0;
+
+    run_heap_type = heap_type;
+    if (heap_type == automatic_heap) {
+        run_heap_type
+            = num_nodes >= RADIX_HEAP_MIN_NODES ? radix_heap : binary_heap;
+    }
+}
+
+double ShortestPaths::distance(uint32_t node) const {
+    if (!reached.isMarked(node)) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    return distances[node];
+}
+
+double ShortestPaths::width(uint32_t node) const {
+    if (!reached.isMarked(node)) {
+        return -1;
+    }
+
+    return distances[node];
+}
+
+void ShortestPaths::setHeapType(ShortestPathHeap heap_type) {
+    this->heap_type = heap_type;
+}
+
+size_t ShortestPaths::numPruned() const { return num_pruned; }
+
+ShortestPaths::ShortestPaths() {
+    heap_type = automatic_heap;
+    run_heap_type = binary_heap;
+    num_pruned = 0;
+}
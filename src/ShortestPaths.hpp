@@ -0,0 +1,145 @@
+#ifndef __SHORTEST_PATHS_HPP__
+#define __SHORTEST_PATHS_HPP__
+
+#include <cinttypes>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+
+#include "CSRArray.hpp"
+#include "NodeMarks.hpp"
+
+/*
+ * enum ShortestPathHeap represents the priority queues ShortestPaths can use.
+ * binary_heap is a plain binary heap, while radix_heap exploits that Dijkstra
+ * extracts keys in increasing order, using the bits of the (non-negative)
+ * distances as integer keys. automatic_heap picks radix_heap for graphs with
+ * at least RADIX_HEAP_MIN_NODES nodes, where it is faster, and binary_heap
+ * for smaller ones.
+ */
+enum ShortestPathHeap { binary_heap = 0, radix_heap, automatic_heap };
+
+// the fewest nodes for which automatic_heap picks radix_heap.
+#define RADIX_HEAP_MIN_NODES 1024
+
+/*
+ * class RadixHeap is a monotone priority queue of nodes keyed by unsigned 64
+ * bit integers: a pushed key can never be smaller than the last popped one.
+ * Keys are kept in buckets by the highest bit in which they differ from the
+ * last popped key, so each key is moved between buckets at most 64 times.
+ */
+class RadixHeap {
+private:
+    std::vector<std::pair<uint64_t, uint32_t>> buckets[65];
+    uint64_t last; // the last popped key.
+    size_t size;
+
+    // bucketIndex returns the bucket in which key is stored.
+    uint32_t bucketIndex(uint64_t key) const;
+
+public:
+    bool empty() const; // empty returns whether there are no keys left.
+
+    // push inserts node with key, which must not be smaller than the last pop.
+    void push(uint64_t key, uint32_t node);
+
+    // pop removes and returns a (key, node) pair with the smallest key.
+    std::pair<uint64_t, uint32_t> pop();
+
+    void clear(); // clear removes all keys, restarting the monotone order.
+
+    RadixHeap(); // Constructs an empty heap.
+};
+
+/*
+ * class ShortestPaths is a single source shortest path engine (Dijkstra's
+ * algorithm) over graphs in the CSR layout of Graph. Dijkstra's algorithm
+ * (and radix_heap's keys) need non-negative weights, so run takes negative
+ * weights as 0. All its buffers are kept between runs, so it is meant to be
+ * reused: starting a new run does not depend on the size of the graph.
+ */
+class ShortestPaths {
+private:
+    ShortestPathHeap heap_type; // the heap chosen with setHeapType.
+    ShortestPathHeap run_heap_type; // the heap of the current run.
+    // best distance (or width, see runWidest) found for each node.
+    std::vector<double> distances;
+    NodeMarks reached; // nodes whose distances are valid in the current run.
+    NodeMarks settled; // nodes whose distances are final in the current run.
+
+    // the heaps, only the one of type run_heap_type is used.
+    std::vector<std::pair<double, uint32_t>> binary;
+    RadixHeap radix;
+
+    // edges of the last run that were not relaxed, see numPruned.
+    size_t num_pruned;
+
+    // push and pop work on the heap of type run_heap_type.
+    void push(double distance, uint32_t node);
+    std::pair<double, uint32_t> pop();
+    bool empty() const;
+
+    /*
+     * clear prepares the engine for a new run on num_nodes nodes, picking
+     * the run's heap if heap_type is automatic_heap.
+     */
+    void clear(size_t num_nodes);
+
+public:
+    /*
+     * run calculates the shortest distances from source to all nodes of the
+     * graph given by offsets, targets and edges (see Graph's CSR layout),
+     * where edges is any array indexed by edge position and weight(edges[i])
+     * is the length of edge i (or 0, if it is negative). If target is not
+     * EMPTY_VALUE, the search stops as soon as target's distance is final, so
+     * only that distance is guaranteed to be correct.
+     */
+    template <class Edges, class Weight>
+    void run(const CSRArray<uint32_t>& offsets,
+        const CSRArray<uint32_t>& targets, const Edges& edges, Weight weight,
+        uint32_t source, ssize_t target);
+
+    /*
+     * distance returns the distance from the last run's source to node, or
+     * infinity if node can't be reached.
+     */
+    double distance(uint32_t node) const;
+
+    /*
+     * runWidest calculates, in the same graph format as run, the widest paths
+     * from source to all nodes, i.e., the paths whose smallest weight is the
+     * largest, where weights must be non-negative. It is Dijkstra's algorithm
+     * with the path's bottleneck in place of its length, and always uses the
+     * binary_heap (as a max heap). If target is not EMPTY_VALUE, the search
+     * stops as soon as target's width is final.
+     */
+    template <class Edges, class Weight>
+    void runWidest(const CSRArray<uint32_t>& offsets,
+        const CSRArray<uint32_t>& targets, const Edges& edges, Weight weight,
+        uint32_t source, ssize_t target);
+
+    /*
+     * width returns the width of the widest path from the last runWidest's
+     * source to node (infinity for the source itself), or -1 if node can't be
+     * reached.
+     */
+    double width(uint32_t node) const;
+
+    /*
+     * setHeapType chooses the priority queue used by the next runs, see
+     * ShortestPathHeap.
+     */
+    void setHeapType(ShortestPathHeap heap_type);
+
+    /*
+     * numPruned returns how many edges the last run (or runWidest) did not
+     * follow, because their ends were already final or no better through
+     * them.
+     */
+    size_t numPruned() const;
+
+    // Constructs an engine that uses an automatic_heap.
+    ShortestPaths();
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef __SHORTEST_PATHS_HXX__
+#define __SHORTEST_PATHS_HXX__
+
+#include <algorithm>
+#include <limits>
+
+#include "CSRArray.hxx"
+#include "ShortestPaths.hpp"
+
+template <class Edges, class Weight>
+void ShortestPaths::run(const CSRArray<uint32_t>& offsets,
+    const CSRArray<uint32_t>& targets, const Edges& edges, Weight weight,
+    uint32_t source, ssize_t target) {
+
+    clear(offsets.size() - 1);
+
+    reached.mark(source);
+    distances[source] = 0;
+    push(0, source);
+
+    while (!empty()) {
+        std::pair<double, uint32_t> top = pop();
+        uint32_t node = top.second;
+
+        if (settled.isMarked(node)) {
+            continue; // an outdated entry, the node was already settled.
+        }
+        settled.mark(node);
+
+        if ((ssize_t)node == target) {
+            return; // the target's distance will not get any better.
+        }
+
+        // relax every edge of the settled node
+        for (uint32_t edge = offsets[node]; edge < offsets[node + 1]; edge++) {
+            uint32_t next = targets[edge];
+            if (settled.isMarked(next)) {
+                num_pruned++;
+                continue;
+            }
+
+            // a negative weight would break Dijkstra (and radix_heap's order)
+            double length = weight(edges[edge]);
+            double new_distance = top.first + std::max(0.0, length);
+            if (!reached.isMarked(next) || new_distance < distances[next]) {
+                reached.mark(next);
+                distances[next] = new_distance;
+                push(new_distance, next);
+            } else {
+                num_pruned++;
+            }
+        }
+    }
+}
+
+template <class Edges, class Weight>
+void ShortestPaths::runWidest(const CSRArray<uint32_t>& offsets,
+    const CSRArray<uint32_t>& targets, const Edges& edges, Weight weight,
+    uint32_t source, ssize_t target) {
+
+    clear(offsets.size() - 1);
+
+    // widths only decrease along a path, so the widest node is popped first
+    reached.mark(source);
+    distances[source] = std::numeric_limits<double>::infinity();
+    binary.push_back(std::make_pair(distances[source], source));
+
+    while (!binary.empty()) {
+        std::pop_heap(binary.begin(), binary.end());
+        std::pair<double, uint32_t> top = binary.back();
+        binary.pop_back();
+        uint32_t node = top.second;
+
+        if (settled.isMarked(node)) {
+            continue; // an outdated entry, the node was already settled.
+        }
+        settled.mark(node);
+
+        if ((ssize_t)node == target) {
+            return; // the target's width will not get any better.
+        }
+
+        // relax every edge of the settled node
+        for (uint32_t edge = offsets[node]; edge < offsets[node + 1]; edge++) {
+            uint32_t next = targets[edge];
+            if (settled.isMarked(next)) {
+                num_pruned++;
+                continue;
+            }
+
+            double new_width = std::min(top.first, (double)weight(edges[edge]));
+            if (!reached.isMarked(next) || new_width > distances[next]) {
+                reached.mark(next);
+                distances[next] = new_width;
+                binary.push_back(std::make_pair(new_width, next));
+                std::push_heap(binary.begin(), binary.end());
+            } else {
+                num_pruned++;
+            }
+        }
+    }
+}
+
+#endif
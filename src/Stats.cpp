@@ -0,0 +1,141 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Stats.hpp"
+
+// the names of each phase and counter, as in the summary.
+static const char* const STAT_PHASE_NAMES[NUM_STAT_PHASES]
+    = { "table_open", "graph_build", "graph_load", "max_speed_query",
+          "length_query", "widest_speed_query", "cicles", "print" };
+static const char* const STAT_COUNTER_NAMES[NUM_STAT_COUNTERS]
+    = { "records_read", "removed_records_skipped", "edges_deduplicated",
+          "augmenting_paths", "length_branches_pruned" };
+
+#define NS_PER_MS 1e6
+
+bool Stats::enabled = false;
+std::string Stats::json_file_name;
+Stats::PhaseTotals Stats::phases[NUM_STAT_PHASES];
+std::atomic<uint64_t> Stats::counters[NUM_STAT_COUNTERS];
+
+void Stats::enable(const std::string& json_file_name) {
+    Stats::json_file_name = json_file_name;
+    if (!enabled) {
+        enabled = true;
+        std::atexit(report);
+    }
+}
+
+bool Stats::enableFromArgument(const char* argument) {
+    size_t length = std::strlen(STATS_ARGUMENT);
+    if (std::strncmp(argument, STATS_ARGUMENT, length) != 0) {
+        return false;
+    }
+
+    if (argument[length] == '\0') {
+        enable("");
+        return true;
+    } else if (argument[length] == '=') {
+        enable(argument + length + 1);
+        return true;
+    }
+
+    return false;
+}
+
+void Stats::enableFromEnvironment() {
+    const char* value = std::getenv(STATS_ENVIRONMENT);
+    if (value != NULL) {
+        enable(value);
+    }
+}
+
+bool Stats::isEnabled() { return enabled; }
+
+void Stats::add(StatCounter counter, uint64_t amount) {
+    if (enabled) {
+        counters[counter].fetch_add(amount, std::memory_order_relaxed);
+    }
+}
+
+void Stats::addPhase(StatPhase phase, uint64_t elapsed_ns) {
+    PhaseTotals& totals = phases[phase];
+    totals.count.fetch_add(1, std::memory_order_relaxed);
+    totals.total_ns.fetch_add(elapsed_ns, std::memory_order_relaxed);
+
+    // other threads may raise the maximum in between
+    uint64_t max_ns = totals.max_ns.load(std::memory_order_relaxed);
+    while (elapsed_ns > max_ns
+        && !totals.max_ns.compare_exchange_weak(
+            max_ns, elapsed_ns, std::memory_order_relaxed)) { }
+}
+
+bool Stats::reportJSON() {
+    FILE* fp = std::fopen(json_file_name.c_str(), "w");
+    if (fp == NULL) {
+        return false;
+    }
+
+    std::fprintf(fp, "{\"phases\": {");
+    for (int phase = 0; phase < NUM_STAT_PHASES; phase++) {
+        std::fprintf(fp,
+            "%s\n  \"%s\": {\"count\": %" PRIu64 ", \"total_ms\": %.6f, "
+            "\"max_ms\": %.6f}",
+            phase == 0 ? "" : ",", STAT_PHASE_NAMES[phase],
+            phases[phase].count.load(), phases[phase].total_ns / NS_PER_MS,
+            phases[phase].max_ns / NS_PER_MS);
+    }
+
+    std::fprintf(fp, "\n},\n\"counters\": {");
+    for (int counter = 0; counter < NUM_STAT_COUNTERS; counter++) {
+        std::fprintf(fp, "%s\n  \"%s\": %" PRIu64, counter == 0 ? "" : ",",
+            STAT_COUNTER_NAMES[counter], counters[counter].load());
+    }
+    std::fprintf(fp, "\n}}\n");
+
+    return std::fclose(fp) == 0;
+}
+
+void Stats::report() {
+    if (!json_file_name.empty()) {
+        if (!reportJSON()) {
+            std::perror(json_file_name.c_str());
+        }
+        return;
+    }
+
+    // phases that never ran are left out
+    std::fprintf(stderr, "%-24s %10s %14s %14s\n", "phase", "count",
+        "total (ms)", "max (ms)");
+    for (int phase = 0; phase < NUM_STAT_PHASES; phase++) {
+        if (phases[phase].count > 0) {
+            std::fprintf(stderr, "%-24s %10" PRIu64 " %14.3f %14.3f\n",
+                STAT_PHASE_NAMES[phase], phases[phase].count.load(),
+                phases[phase].total_ns / NS_PER_MS,
+                phases[phase].max_ns / NS_PER_MS);
+        }
+    }
+
+    std::fprintf(stderr, "%-24s %10s\n", "counter", "count");
+    for (int counter = 0; counter < NUM_STAT_COUNTERS; counter++) {
+        std::fprintf(stderr, "%-24s %10" PRIu64 "\n",
+            STAT_COUNTER_NAMES[counter], counters[counter].load());
+    }
+}
+
+StatTimer::StatTimer(StatPhase phase) {
+    this->phase = phase;
+    running = Stats::isEnabled();
+    if (running) {
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+StatTimer::~StatTimer() {
+    if (running) {
+        std::chrono::nanoseconds elapsed
+            = std::chrono::steady_clock::now() - start;
+        Stats::addPhase(phase, elapsed.count());
+    }
+}
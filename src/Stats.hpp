@@ -0,0 +1,112 @@
+#ifndef __STATS_HPP__
+#define __STATS_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <string>
+
+/*
+ * the argument that enables Stats, as "--stats" to write the summary to
+ * stderr or "--stats=file" to write it as JSON to file. The environment
+ * variable does the same, with an empty value meaning stderr.
+ */
+#define STATS_ARGUMENT "--stats"
+#define STATS_ENVIRONMENT "NETWORK_STATS"
+
+/*
+ * enum StatPhase represents every phase timed by Stats, each one a scope
+ * that may run many times, possibly in different threads at once.
+ */
+enum StatPhase {
+    stat_table_open = 0,
+    stat_graph_build,
+    stat_graph_load,
+    stat_max_speed_query,
+    stat_length_query,
+    stat_widest_speed_query,
+    stat_cicles,
+    stat_print,
+    NUM_STAT_PHASES
+};
+
+/*
+ * enum StatCounter represents every event counted by Stats.
+ */
+enum StatCounter {
+    stat_records_read = 0,
+    stat_removed_records_skipped,
+    stat_edges_deduplicated,
+    stat_augmenting_paths,
+    stat_length_branches_pruned,
+    NUM_STAT_COUNTERS
+};
+
+/*
+ * class Stats gathers the time spent in each phase of the program and counts
+ * of events in it, from any thread, to be summarized at exit. While it is
+ * disabled (the default), timers and counters do nothing but check whether
+ * it is enabled, so hot loops count in local variables and add them once.
+ */
+class Stats {
+private:
+    // PhaseTotals holds how many times a phase ran and for how long.
+    struct PhaseTotals {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> total_ns;
+        std::atomic<uint64_t> max_ns;
+    };
+
+    static bool enabled;
+    static std::string json_file_name; // empty to write to stderr.
+    static PhaseTotals phases[NUM_STAT_PHASES];
+    static std::atomic<uint64_t> counters[NUM_STAT_COUNTERS];
+
+    // report writes the summary, registered with atexit by enable.
+    static void report();
+
+    // reportJSON writes the summary as JSON to json_file_name.
+    static bool reportJSON();
+
+public:
+    /*
+     * enable starts gathering stats, to be written when the program exits:
+     * as JSON to the file named json_file_name or, if it is empty, as text
+     * to stderr. It must be called before any other thread is started.
+     */
+    static void enable(const std::string& json_file_name);
+
+    /*
+     * enableFromArgument enables Stats if argument is STATS_ARGUMENT (with
+     * or without a file), returning whether it was.
+     */
+    static bool enableFromArgument(const char* argument);
+
+    // enableFromEnvironment enables Stats if STATS_ENVIRONMENT is set.
+    static void enableFromEnvironment();
+
+    static bool isEnabled(); // isEnabled returns whether Stats is enabled.
+
+    // add adds amount to counter, if enabled.
+    static void add(StatCounter counter, uint64_t amount);
+
+    // addPhase adds a run of phase that took elapsed_ns nanoseconds.
+    static void addPhase(StatPhase phase, uint64_t elapsed_ns);
+};
+
+/*
+ * class StatTimer times its own scope as a run of a phase, if Stats is
+ * enabled when it is constructed.
+ */
+class StatTimer {
+private:
+    StatPhase phase;
+    bool running;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    StatTimer(StatPhase phase); // Constructs a timer started now.
+    ~StatTimer(); // Adds the time since construction to the phase.
+};
+
+#endif
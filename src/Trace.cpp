@@ -0,0 +1,210 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "Trace.hpp"
+
+#define NS_PER_US 1e3
+
+bool Trace::enabled = false;
+std::string Trace::file_name;
+uint64_t Trace::epoch_ns = 0;
+std::atomic<TraceBuffer*> Trace::buffers(NULL);
+std::atomic<uint32_t> Trace::num_buffers(0);
+TraceBuffer* Trace::free_buffers = NULL;
+std::mutex Trace::free_buffers_mutex;
+
+// steadyNow returns the time of the steady clock, in nanoseconds.
+static uint64_t steadyNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void Trace::enable(const std::string& file_name) {
+    Trace::file_name = file_name;
+    if (!enabled) {
+        epoch_ns = steadyNow();
+        enabled = true;
+        std::atexit(dump);
+    }
+}
+
+bool Trace::enableFromArgument(const char* argument) {
+    size_t length = std::strlen(TRACE_ARGUMENT);
+    if (std::strncmp(argument, TRACE_ARGUMENT, length) != 0
+        || argument[length] != '=' || argument[length + 1] == '\0') {
+        return false;
+    }
+
+    enable(argument + length + 1);
+    return true;
+}
+
+void Trace::enableFromEnvironment() {
+    const char* value = std::getenv(TRACE_ENVIRONMENT);
+    if (value != NULL && value[0] != '\0') {
+        enable(value);
+    }
+}
+
+bool Trace::isEnabled() { return enabled; }
+
+uint64_t Trace::now() { return steadyNow() - epoch_ns; }
+
+Trace::ThreadBuffer::ThreadBuffer() { buffer = NULL; }
+
+Trace::ThreadBuffer::~ThreadBuffer() {
+    if (buffer != NULL) {
+        std::lock_guard<std::mutex> lock(free_buffers_mutex);
+        buffer->next_free = free_buffers;
+        free_buffers = buffer;
+    }
+}
+
+TraceBuffer* Trace::claimBuffer() {
+    {
+        std::lock_guard<std::mutex> lock(free_buffers_mutex);
+        TraceBuffer* buffer = free_buffers;
+        if (buffer != NULL) {
+            free_buffers = buffer->next_free;
+            return buffer;
+        }
+    }
+
+    TraceBuffer* buffer = new TraceBuffer;
+    buffer->num_events = 0;
+    buffer->index = num_buffers.fetch_add(1);
+
+    // push the buffer on the stack, retrying if another thread got first
+    buffer->next = buffers.load();
+    while (!buffers.compare_exchange_weak(buffer->next, buffer)) { }
+
+    return buffer;
+}
+
+TraceBuffer* Trace::threadBuffer() {
+    thread_local ThreadBuffer thread_buffer;
+    if (thread_buffer.buffer == NULL) {
+        thread_buffer.buffer = claimBuffer();
+    }
+
+    return thread_buffer.buffer;
+}
+
+void Trace::record(const TraceEvent& event) {
+    TraceBuffer* buffer = threadBuffer();
+    uint64_t index = buffer->num_events.load(std::memory_order_relaxed);
+
+    buffer->events[index % TRACE_BUFFER_EVENTS] = event;
+    buffer->num_events.store(index + 1, std::memory_order_release);
+}
+
+/*
+ * writeEvent writes event, of the buffer with index thread, as a complete
+ * event ("X") of the Chrome trace format to fp. The events of the threads
+ * that shared a buffer never overlap, so they are shown as one thread.
+ */
+static void writeEvent(FILE* fp, const TraceEvent& event, uint32_t thread) {
+    std::fprintf(fp,
+        ",\n{\"name\": \"%s\", \"cat\": \"network\", \"ph\": \"X\", "
+        "\"ts\": %.3f, \"dur\": %.3f, \"pid\": %d, \"tid\": %u, \"args\": {",
+        event.name, event.start_ns / NS_PER_US,
+        event.duration_ns / NS_PER_US, (int)getpid(), thread);
+
+    for (uint32_t i = 0; i < event.num_arguments; i++) {
+        std::fprintf(fp, "%s\"%s\": %" PRId64, i == 0 ? "" : ", ",
+            event.argument_names[i], event.arguments[i]);
+    }
+    std::fprintf(fp, "}}");
+}
+
+void Trace::dump() {
+    FILE* fp = std::fopen(file_name.c_str(), "w");
+    if (fp == NULL) {
+        std::perror(file_name.c_str());
+        return;
+    }
+
+    // the first event only names the process, so the others start with ","
+    std::fprintf(fp,
+        "{\"traceEvents\": [\n{\"name\": \"process_name\", \"ph\": \"M\", "
+        "\"pid\": %d, \"args\": {\"name\": \"network\"}}",
+        (int)getpid());
+
+    uint64_t dropped = 0;
+    for (TraceBuffer* buffer = buffers.load(); buffer != NULL;
+         buffer = buffer->next) {
+
+        // only the last TRACE_BUFFER_EVENTS events are still in the buffer
+        uint64_t num_events
+            = buffer->num_events.load(std::memory_order_acquire);
+        uint64_t first = num_events > TRACE_BUFFER_EVENTS
+            ? num_events - TRACE_BUFFER_EVENTS
+            : 0;
+        dropped += first;
+
+        for (uint64_t index = first; index < num_events; index++) {
+            writeEvent(fp, buffer->events[index % TRACE_BUFFER_EVENTS],
+                buffer->index);
+        }
+    }
+
+    std::fprintf(fp,
+        "\n],\n\"displayTimeUnit\": \"ns\",\n"
+        "\"otherData\": {\"dropped_events\": %" PRIu64 "}}\n",
+        dropped);
+
+    if (std::fclose(fp) != 0) {
+        std::perror(file_name.c_str());
+    }
+}
+
+TraceScope::TraceScope(const char* name) {
+    running = Trace::isEnabled();
+    if (running) {
+        event.name = name;
+        event.num_arguments = 0;
+        Trace::threadBuffer();
+        event.start_ns = Trace::now();
+    }
+}
+
+TraceScope::TraceScope(
+    const char* name, const char* argument_name, int64_t argument) {
+
+    running = Trace::isEnabled();
+    if (running) {
+        event.name = name;
+        event.argument_names[0] = argument_name;
+        event.arguments[0] = argument;
+        event.num_arguments = 1;
+        Trace::threadBuffer();
+        event.start_ns = Trace::now();
+    }
+}
+
+TraceScope::TraceScope(const char* name, const char* argument_a_name,
+    int64_t argument_a, const char* argument_b_name, int64_t argument_b) {
+
+    running = Trace::isEnabled();
+    if (running) {
+        event.name = name;
+        event.argument_names[0] = argument_a_name;
+        event.arguments[0] = argument_a;
+        event.argument_names[1] = argument_b_name;
+        event.arguments[1] = argument_b;
+        event.num_arguments = 2;
+        Trace::threadBuffer();
+        event.start_ns = Trace::now();
+    }
+}
+
+TraceScope::~TraceScope() {
+    if (running) {
+        event.duration_ns = Trace::now() - event.start_ns;
+        Trace::record(event);
+    }
+}
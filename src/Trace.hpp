@@ -0,0 +1,149 @@
+#ifndef __TRACE_HPP__
+#define __TRACE_HPP__
+
+#include <atomic>
+#include <cinttypes>
+#include <mutex>
+#include <string>
+
+/*
+ * the argument that enables Trace, as "--trace=file", and the environment
+ * variable that does the same with the file as its value.
+ */
+#define TRACE_ARGUMENT "--trace"
+#define TRACE_ENVIRONMENT "NETWORK_TRACE"
+
+/*
+ * how many events each buffer keeps. When a buffer is full, its oldest events
+ * are overwritten and counted as dropped.
+ */
+#define TRACE_BUFFER_EVENTS (1 << 16)
+
+// the most arguments an event can have.
+#define TRACE_MAX_ARGUMENTS 2
+
+/*
+ * struct TraceEvent is a complete event: a scope named name that started
+ * start_ns nanoseconds after tracing was enabled and took duration_ns, with
+ * num_arguments integer arguments. Names must be string literals.
+ */
+struct TraceEvent {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    const char* argument_names[TRACE_MAX_ARGUMENTS];
+    int64_t arguments[TRACE_MAX_ARGUMENTS];
+    uint32_t num_arguments;
+};
+
+/*
+ * struct TraceBuffer is a ring buffer claimed by one thread at a time. Only
+ * that thread writes events, publishing each one by increasing num_events,
+ * so events are recorded without locks. When the thread ends, the buffer
+ * goes back to a pool and the next thread that traces keeps appending to
+ * it, so there are only as many buffers as threads ever traced at once.
+ * Buffers are never freed, since they must be dumped at exit.
+ */
+struct TraceBuffer {
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+    std::atomic<uint64_t> num_events; // events ever recorded.
+    uint32_t index; // the order in which the buffer was created.
+    TraceBuffer* next; // the buffer created before this one.
+    TraceBuffer* next_free; // the next buffer in the pool, if in it.
+};
+
+/*
+ * class Trace records scoped events of every thread, dumped when the program
+ * exits as a Chrome trace (JSON), which trace viewers such as Perfetto and
+ * chrome://tracing load. While it is disabled (the default), scopes do
+ * nothing but check whether it is enabled.
+ */
+class Trace {
+private:
+    static bool enabled;
+    static std::string file_name;
+    static uint64_t epoch_ns; // when tracing was enabled.
+
+    // buffers is a lock-free stack of every buffer ever created.
+    static std::atomic<TraceBuffer*> buffers;
+    static std::atomic<uint32_t> num_buffers;
+
+    // free_buffers is the pool of buffers no thread holds.
+    static TraceBuffer* free_buffers;
+    static std::mutex free_buffers_mutex;
+
+    /*
+     * struct ThreadBuffer holds the buffer a thread claimed, returning it to
+     * the pool when the thread ends.
+     */
+    struct ThreadBuffer {
+        TraceBuffer* buffer;
+
+        ThreadBuffer(); // Constructs a ThreadBuffer with no buffer yet.
+        ~ThreadBuffer(); // Returns the buffer to the pool.
+    };
+
+    /*
+     * claimBuffer takes a buffer from the pool, or creates one if the pool
+     * is empty.
+     */
+    static TraceBuffer* claimBuffer();
+
+    // dump writes every buffer to file_name, registered with atexit.
+    static void dump();
+
+public:
+    /*
+     * enable starts tracing, to be dumped to the file named file_name at
+     * exit. It must be called before any other thread is started.
+     */
+    static void enable(const std::string& file_name);
+
+    /*
+     * enableFromArgument enables Trace if argument is TRACE_ARGUMENT with a
+     * file, returning whether it was.
+     */
+    static bool enableFromArgument(const char* argument);
+
+    // enableFromEnvironment enables Trace if TRACE_ENVIRONMENT is set.
+    static void enableFromEnvironment();
+
+    static bool isEnabled(); // isEnabled returns whether Trace is enabled.
+
+    // now returns the nanoseconds since tracing was enabled.
+    static uint64_t now();
+
+    /*
+     * threadBuffer returns the calling thread's buffer, claiming it the first
+     * time. Scopes claim it when they start, so a buffer's events never
+     * overlap with the ones of the threads that held it before.
+     */
+    static TraceBuffer* threadBuffer();
+
+    // record copies event to the calling thread's buffer.
+    static void record(const TraceEvent& event);
+};
+
+/*
+ * class TraceScope records its own scope as an event, if Trace is enabled
+ * when it is constructed, with up to TRACE_MAX_ARGUMENTS named arguments.
+ */
+class TraceScope {
+private:
+    TraceEvent event;
+    bool running;
+
+public:
+    TraceScope(const char* name); // Constructs a scope started now.
+
+    // Constructs a scope with the argument named argument_name.
+    TraceScope(const char* name, const char* argument_name, int64_t argument);
+
+    // Constructs a scope with two arguments.
+    TraceScope(const char* name, const char* argument_a_name,
+        int64_t argument_a, const char* argument_b_name, int64_t argument_b);
+
+    ~TraceScope(); // Records the scope, which ends now.
+};
+
+#endif
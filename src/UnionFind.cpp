@@ -0,0 +1,46 @@
+#include <utility>
+
+#include "UnionFind.hpp"
+
+void UnionFind::reset(size_t num_nodes) {
+    parents.resize(num_nodes);
+    sizes.assign(num_nodes, 1);
+
+    for (size_t node = 0; node < num_nodes; node++) {
+        parents[node] = node;
+    }
+}
+
+uint32_t UnionFind::insert() {
+    parents.push_back(parents.size());
+    sizes.push_back(1);
+
+    return parents.size() - 1;
+}
+
+uint32_t UnionFind::find(uint32_t node_index) {
+    while (parents[node_index] != node_index) {
+        // make the node skip its parent on the way up
+        parents[node_index] = parents[parents[node_index]];
+        node_index = parents[node_index];
+    }
+
+    return node_index;
+}
+
+bool UnionFind::merge(uint32_t node_a, uint32_t node_b) {
+    node_a = find(node_a);
+    node_b = find(node_b);
+    if (node_a == node_b) {
+        return false;
+    }
+
+    // the smaller set hangs from the larger one
+    if (sizes[node_a] < sizes[node_b]) {
+        std::swap(node_a, node_b);
+    }
+
+    parents[node_b] = node_a;
+    sizes[node_a] += sizes[node_b];
+    return true;
+}
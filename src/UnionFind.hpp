@@ -0,0 +1,34 @@
+#ifndef __UNION_FIND_HPP__
+#define __UNION_FIND_HPP__
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+/*
+ * class UnionFind is a disjoint set forest over nodes given by their dense
+ * indices (see Graph), with union by size and path halving, so any sequence
+ * of operations takes nearly constant time per operation.
+ */
+class UnionFind {
+private:
+    std::vector<uint32_t> parents; // parent of each node, roots are their own.
+    std::vector<uint32_t> sizes; // number of nodes in the set of each root.
+
+public:
+    // reset makes every one of num_nodes nodes a set of its own.
+    void reset(size_t num_nodes);
+
+    // insert adds a new node in a set of its own, returning its index.
+    uint32_t insert();
+
+    uint32_t find(uint32_t node_index); // find returns the node's set root.
+
+    /*
+     * merge joins the sets of nodes a and b, returning false if they already
+     * were in the same set.
+     */
+    bool merge(uint32_t node_a, uint32_t node_b);
+};
+
+#endif
@@ -1,64 +1,348 @@
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+
 #include "commands.hpp"
+#include "InputBuffer.hpp"
 #include "NetworkGraph.hpp"
+#include "NetworkSnapshot.hpp"
+#include "OutputBuffer.hpp"
+#include "ParallelFor.hxx"
+#include "Stats.hpp"
+#include "Trace.hpp"
 
-void commandMaxSpeed(NetworkGraph& net_topology) {
-    int32_t num_calculations;
-    std::cin >> num_calculations;
+bool runCommand(int32_t command, NetworkGraph& net_topology, InputBuffer& in,
+    std::ostream& out) {
 
-    // for every calculation needed
-    for (int32_t check = 0; check < num_calculations; check++) {
-        // get a starting and an ending node id
-        int32_t origin_pop;
-        int32_t destination_pop;
-
-        std::cin >> origin_pop >> destination_pop;
-        std::cout << "Fluxo máximo entre " << origin_pop;
-        std::cout << " e " << destination_pop << ": ";
-
-        // calculate the maximum speed
-        int32_t max_speed
-            = net_topology.getMaxSpeed(origin_pop, destination_pop);
-        if (max_speed == -1) {
+    switch (command) {
+    case command_print:
+        commandPrint(net_topology, out);
+        break;
+    case command_num_cicles:
+        commandNumCicles(net_topology, out);
+        break;
+    case command_max_speed:
+        commandMaxSpeed(net_topology, in, out);
+        break;
+    case command_length:
+        commandLength(net_topology, in, out);
+        break;
+    case command_widest_speed:
+        commandWidestSpeed(net_topology, in, out);
+        break;
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * readPairs reads the number of pairs of a batch and then the pairs, see
+ * commandMaxSpeed.
+ */
+static void readPairs(InputBuffer& in, std::vector<int32_t>& origin_pops,
+    std::vector<int32_t>& destination_pops);
+
+/*
+ * readTriples reads the number of triples of a batch and then the triples,
+ * see commandLength.
+ */
+static void readTriples(InputBuffer& in, std::vector<int32_t>& origin_pops,
+    std::vector<int32_t>& destination_pops, std::vector<int32_t>& stops);
+
+bool runCommand(int32_t command, const NetworkSnapshot& snapshot,
+    InputBuffer& in, std::ostream& out) {
+    const NetworkGraph& net_topology = snapshot.getGraph();
+    std::vector<int32_t> origin_pops;
+    std::vector<int32_t> destination_pops;
+    std::vector<int32_t> stops;
+
+    switch (command) {
+    case command_print:
+        commandPrint(net_topology, out);
+        break;
+    case command_num_cicles:
+        commandNumCicles(net_topology, out);
+        break;
+    case command_max_speed:
+        readPairs(in, origin_pops, destination_pops);
+        answerMaxSpeeds(net_topology, origin_pops, destination_pops, out);
+        break;
+    case command_length:
+        readTriples(in, origin_pops, destination_pops, stops);
+        answerLengths(
+            net_topology, origin_pops, destination_pops, stops, out);
+        break;
+    case command_widest_speed:
+        readPairs(in, origin_pops, destination_pops);
+        answerWidestSpeeds(net_topology, origin_pops, destination_pops, out);
+        break;
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+void commandPrint(const NetworkGraph& net_topology, std::ostream& out) {
+    StatTimer timer(stat_print);
+    TraceScope trace("print");
+    out << net_topology;
+}
+
+void commandNumCicles(NetworkGraph& net_topology, std::ostream& out) {
+    net_topology.freeze();
+    commandNumCicles(static_cast<const NetworkGraph&>(net_topology), out);
+}
+
+void commandNumCicles(const NetworkGraph& net_topology, std::ostream& out) {
+    StatTimer timer(stat_cicles);
+    TraceScope trace("cicles");
+    bool truncated;
+    int32_t cicles
+        = net_topology.getNumCicles(std::thread::hardware_concurrency(),
+            CICLE_SPLIT_DEPTH, CICLE_COUNT_BUDGET, truncated);
+
+    OutputBuffer buffer(out);
+
+    if (truncated) {
+        // too many paths to walk, so count only the independent cicles
+        std::cerr << "contagem exata de ciclos interrompida, usando o ";
+        std::cerr << "número ciclomático" << std::endl;
+        buffer << "Quantidade de ciclos independentes (número ciclomático): "
+               << net_topology.getCyclomaticNumber() << '\n';
+        return;
+    }
+
+    buffer << "Quantidade de ciclos: " << cicles << '\n';
+}
+
+/*
+ * queryThreads returns how many threads answer batches of queries: one for
+ * each available core.
+ */
+static uint32_t queryThreads() {
+    return std::max<uint32_t>(1, std::thread::hardware_concurrency());
+}
+
+/*
+ * readNumCalculations reads the number of calculations of a batch, which is
+ * 0 if it could not be read or is negative.
+ */
+static size_t readNumCalculations(InputBuffer& in) {
+    int32_t num_calculations = 0;
+    in.read(num_calculations);
+    return std::max(0, num_calculations);
+}
+
+static void readPairs(InputBuffer& in, std::vector<int32_t>& origin_pops,
+    std::vector<int32_t>& destination_pops) {
+    in.readColumns(
+        readNumCalculations(in), { &origin_pops, &destination_pops });
+}
+
+static void readTriples(InputBuffer& in, std::vector<int32_t>& origin_pops,
+    std::vector<int32_t>& destination_pops, std::vector<int32_t>& stops) {
+    in.readColumns(readNumCalculations(in),
+        { &origin_pops, &destination_pops, &stops });
+}
+
+void commandMaxSpeed(
+    NetworkGraph& net_topology, InputBuffer& in, std::ostream& out) {
+    // read every pair first, so they can be calculated in parallel
+    std::vector<int32_t> origin_pops;
+    std::vector<int32_t> destination_pops;
+    readPairs(in, origin_pops, destination_pops);
+
+    answerMaxSpeeds(net_topology, origin_pops, destination_pops, out);
+}
+
+void answerMaxSpeeds(NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops, std::ostream& out) {
+    /*
+     * precomputing takes one maximum flow per node, so it pays off as soon as
+     * there are more calculations than nodes
+     */
+    if (origin_pops.size() > net_topology.getNumNodes()) {
+        net_topology.precomputeMaxSpeeds();
+    }
+
+    net_topology.freeze();
+    answerMaxSpeeds(static_cast<const NetworkGraph&>(net_topology),
+        origin_pops, destination_pops, out);
+}
+
+void answerMaxSpeeds(const NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops, std::ostream& out) {
+    size_t num_calculations = origin_pops.size();
+
+    // every thread calculates maximum speeds with its own engine
+    std::vector<MaxFlow> max_flows(queryThreads());
+    std::vector<int32_t> max_speeds(num_calculations);
+
+    parallelFor(num_calculations, max_flows.size(),
+        [&](uint32_t thread, size_t check) {
+            max_speeds[check] = net_topology.getMaxSpeed(origin_pops[check],
+                destination_pops[check], max_flows[thread]);
+        });
+
+    // answer in the same order as the pairs were given
+    OutputBuffer buffer(out);
+    for (size_t check = 0; check < num_calculations; check++) {
+        buffer << "Fluxo máximo entre " << origin_pops[check];
+        buffer << " e " << destination_pops[check] << ": ";
+
+        if (max_speeds[check] == -1) {
             // if it's invalid, no unit is needed
-            std::cout << max_speed << std::endl;
+            buffer << max_speeds[check] << '\n';
             continue;
         }
 
-        std::cout << max_speed << " Mbps" << std::endl;
+        buffer << max_speeds[check] << " Mbps\n";
     }
 }
 
-void commandLength(NetworkGraph& net_topology) {
-    int32_t num_calculations;
-    std::cin >> num_calculations;
+void commandLength(
+    NetworkGraph& net_topology, InputBuffer& in, std::ostream& out) {
+    // get a starting, an ending, and a nedded stop node ids for each triple
+    std::vector<int32_t> origin_pops;
+    std::vector<int32_t> destination_pops;
+    std::vector<int32_t> stops;
+    readTriples(in, origin_pops, destination_pops, stops);
 
-    // for every calculation needed
-    for (int32_t check = 0; check < num_calculations; check++) {
-        int32_t origin_pop;
-        int32_t destination_pop;
-        int32_t stop;
-
-        // get a starting, an ending, and a nedded stop node ids
-        std::cin >> origin_pop >> destination_pop >> stop;
-        std::cout << "Comprimento do caminho entre " << origin_pop << " e ";
-        std::cout << destination_pop << " parando em " << stop << ": ";
-
-        // minimum length from the stop to the destination
-        int32_t min_len_cb = net_topology.getLen(stop, destination_pop);
-        if (min_len_cb < 0) {
-            // if it's invalid, no unit is needed, and don't calculate all, it's
-            // going to be invalid anyway
-            std::cout << -1 << std::endl;
+    answerLengths(net_topology, origin_pops, destination_pops, stops, out);
+}
+
+void answerLengths(NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops,
+    const std::vector<int32_t>& stops, std::ostream& out) {
+    net_topology.freeze();
+    answerLengths(static_cast<const NetworkGraph&>(net_topology), origin_pops,
+        destination_pops, stops, out);
+}
+
+void answerLengths(const NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops,
+    const std::vector<int32_t>& stops, std::ostream& out) {
+    size_t num_calculations = origin_pops.size();
+
+    // group the triples by their needed stop
+    std::map<int32_t, std::vector<int32_t>> checks_by_stop;
+    for (size_t check = 0; check < num_calculations; check++) {
+        checks_by_stop[stops[check]].push_back(check);
+    }
+
+    // every thread calculates the groups of stops with its own engine
+    std::vector<std::pair<int32_t, std::vector<int32_t>>> stop_groups(
+        checks_by_stop.begin(), checks_by_stop.end());
+    std::vector<ShortestPaths> shortest_paths(queryThreads());
+    std::vector<int32_t> min_lens(num_calculations);
+
+    parallelFor(stop_groups.size(), shortest_paths.size(),
+        [&](uint32_t thread, size_t group) {
+            const std::vector<int32_t>& stop_checks = stop_groups[group].second;
+
+            /*
+             * the graph is non-directed, so a single computation from the
+             * stop gives both the length from the origin to the stop and from
+             * the stop to the destination for all triples with this stop
+             */
+            std::vector<int32_t> node_ids;
+            for (int32_t check : stop_checks) {
+                node_ids.push_back(destination_pops[check]);
+                node_ids.push_back(origin_pops[check]);
+            }
+
+            std::vector<double> lens = net_topology.getLens(
+                stop_groups[group].first, node_ids, shortest_paths[thread]);
+
+            for (size_t i = 0; i < stop_checks.size(); i++) {
+                // from the stop to the destination and from the start to the
+                // stop
+                int32_t min_len_cb = lens[2 * i];
+                int32_t min_len_ac = lens[2 * i + 1];
+
+                // if any is invalid, the whole path is invalid
+                if (min_len_cb < 0 || min_len_ac < 0) {
+                    min_lens[stop_checks[i]] = -1;
+                } else {
+                    min_lens[stop_checks[i]] = min_len_ac + min_len_cb;
+                }
+            }
+        });
+
+    // answer in the same order as the triples were given
+    OutputBuffer buffer(out);
+    for (size_t check = 0; check < num_calculations; check++) {
+        buffer << "Comprimento do caminho entre " << origin_pops[check];
+        buffer << " e " << destination_pops[check] << " parando em ";
+        buffer << stops[check] << ": ";
+
+        if (min_lens[check] < 0) {
+            // if it's invalid, no unit is needed
+            buffer << -1 << '\n';
             continue;
         }
 
-        // minimum lenght from the start to the stop
-        int32_t min_len_ac = net_topology.getLen(origin_pop, stop);
-        if (min_len_ac < 0) {
-            std::cout << -1 << std::endl;
+        buffer << min_lens[check] << "Mbps\n";
+    }
+}
+
+void commandWidestSpeed(
+    NetworkGraph& net_topology, InputBuffer& in, std::ostream& out) {
+    // get a starting and an ending node id for each pair
+    std::vector<int32_t> origin_pops;
+    std::vector<int32_t> destination_pops;
+    readPairs(in, origin_pops, destination_pops);
+
+    answerWidestSpeeds(net_topology, origin_pops, destination_pops, out);
+}
+
+void answerWidestSpeeds(NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops, std::ostream& out) {
+    /*
+     * building the forest costs about as much as a single search, so it pays
+     * off as soon as there is more than one calculation
+     */
+    if (origin_pops.size() > 1) {
+        net_topology.precomputeWidestSpeeds();
+    }
+
+    net_topology.freeze();
+    answerWidestSpeeds(static_cast<const NetworkGraph&>(net_topology),
+        origin_pops, destination_pops, out);
+}
+
+void answerWidestSpeeds(const NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops, std::ostream& out) {
+    size_t num_calculations = origin_pops.size();
+    ShortestPaths widest_paths;
+
+    // for every calculation needed
+    OutputBuffer buffer(out);
+    for (size_t check = 0; check < num_calculations; check++) {
+        buffer << "Velocidade do caminho mais rápido entre ";
+        buffer << origin_pops[check] << " e " << destination_pops[check];
+        buffer << ": ";
+
+        // calculate the widest path's speed
+        int32_t widest_speed = net_topology.getWidestSpeed(
+            origin_pops[check], destination_pops[check], widest_paths);
+        if (widest_speed == -1) {
+            // if it's invalid, no unit is needed
+            buffer << widest_speed << '\n';
             continue;
         }
 
-        std::cout << min_len_ac + min_len_cb << "Mbps" << std::endl;
+        buffer << widest_speed << " Mbps\n";
     }
-}
\ No newline at end of file
+}
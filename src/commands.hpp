@@ -1,7 +1,65 @@
 #ifndef __COMMANDS_HPP__
 #define __COMMANDS_HPP__
 
+#include <cinttypes>
+#include <ostream>
+#include <vector>
+
+#include "InputBuffer.hpp"
 #include "NetworkGraph.hpp"
+#include "NetworkSnapshot.hpp"
+
+/*
+ * the number of edges the exact cicle count may walk before command 12 falls
+ * back to the cyclomatic number, see Graph::getNumCicles.
+ */
+#define CICLE_COUNT_BUDGET 50000000
+
+/*
+ * how many edges from each node the paths of the cicle count are split into
+ * tasks shared by all threads, see Graph::getNumCicles.
+ */
+#define CICLE_SPLIT_DEPTH 2
+
+#define FIRST_COMMAND_NUM 11
+enum commands {
+    command_print = FIRST_COMMAND_NUM,
+    command_num_cicles,
+    command_max_speed,
+    command_length,
+    command_widest_speed
+};
+
+/*
+ * runCommand runs the command with number command over net_topology, reading
+ * its input from in and writing its output to out. It returns false if the
+ * command number is invalid. Commands write through an OutputBuffer, so out
+ * is written in large blocks and never flushed by them.
+ */
+bool runCommand(int32_t command, NetworkGraph& net_topology, InputBuffer& in,
+    std::ostream& out);
+
+/*
+ * runCommand does the same over the graph of snapshot, as it is: nothing is
+ * precomputed for the commands, so any number of threads can run commands
+ * over the same snapshot. Trees precomputed before the snapshot was taken
+ * are still used.
+ */
+bool runCommand(int32_t command, const NetworkSnapshot& snapshot,
+    InputBuffer& in, std::ostream& out);
+
+// commandPrint prints every node of net_topology with each of its connections.
+void commandPrint(const NetworkGraph& net_topology, std::ostream& out);
+
+/*
+ * commandNumCicles prints the number of cicles in net_topology, counted in
+ * parallel by every core. If the count takes more than CICLE_COUNT_BUDGET
+ * steps, it prints the cyclomatic number instead, under its own label so it
+ * is not mistaken for the exact count, and warns about it in the standard
+ * error.
+ */
+void commandNumCicles(NetworkGraph& net_topology, std::ostream& out);
+void commandNumCicles(const NetworkGraph& net_topology, std::ostream& out);
 
 /*
  * commandMaxSpeed reads an integer n passed by the user, and
@@ -9,16 +67,74 @@
  * name suggests, this is the pair of addresses of an origin POP and
  * the address of a destination POP. For each pair, it prints the
  * maximum possible speed of connection between origin POP and
- * destination POP.
+ * destination POP. If there are more pairs than nodes in the graph, the
+ * maximum speeds are precomputed, see NetworkGraph::precomputeMaxSpeeds. All
+ * pairs are read first and calculated in parallel, one thread per core, but
+ * they are answered in the same order.
+ */
+void commandMaxSpeed(
+    NetworkGraph& net_topology, InputBuffer& in, std::ostream& out);
+
+/*
+ * answerMaxSpeeds answers the pairs already read by commandMaxSpeed, with the
+ * origin and destination POPs of pair i in origin_pops[i] and
+ * destination_pops[i]. The const overload answers them over net_topology as
+ * it is, which must already be frozen, and the others only prepare the graph
+ * (precomputing and freezing it) before calling it. The same goes for the
+ * other commands.
  */
-void commandMaxSpeed(NetworkGraph& net_topology);
+void answerMaxSpeeds(NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops, std::ostream& out);
+void answerMaxSpeeds(const NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops, std::ostream& out);
 
 /*
  * commandLength reads an integer n passed by the user, and reads
  * n times a triple (origin_pop, destination_pop, stop). For each triple,
  * it prints the minimum length between origin_pop and destination_pop
- * if one is required to pass at 'stop'.
+ * if one is required to pass at 'stop'. All triples are read before any is
+ * answered, so that triples with the same stop share a single shortest path
+ * computation, and the stops are calculated in parallel, one thread per
+ * core, but they are answered in the same order.
+ */
+void commandLength(
+    NetworkGraph& net_topology, InputBuffer& in, std::ostream& out);
+
+/*
+ * answerLengths answers the triples already read by commandLength, in the
+ * same way as answerMaxSpeeds, with the stop of triple i in stops[i].
+ */
+void answerLengths(NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops,
+    const std::vector<int32_t>& stops, std::ostream& out);
+void answerLengths(const NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops,
+    const std::vector<int32_t>& stops, std::ostream& out);
+
+/*
+ * commandWidestSpeed reads an integer n passed by the user, and reads n times
+ * a pair of integers origin_pop and destination_pop. For each pair, it prints
+ * the speed of the fastest single path between origin_pop and
+ * destination_pop, i.e., the one whose slowest connection is the fastest. If
+ * there is more than one pair, a maximum spanning forest is precomputed, see
+ * NetworkGraph::precomputeWidestSpeeds.
+ */
+void commandWidestSpeed(
+    NetworkGraph& net_topology, InputBuffer& in, std::ostream& out);
+
+/*
+ * answerWidestSpeeds answers the pairs already read by commandWidestSpeed, in
+ * the same way as answerMaxSpeeds.
  */
-void commandLength(NetworkGraph& net_topology);
+void answerWidestSpeeds(NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops, std::ostream& out);
+void answerWidestSpeeds(const NetworkGraph& net_topology,
+    const std::vector<int32_t>& origin_pops,
+    const std::vector<int32_t>& destination_pops, std::ostream& out);
 
 #endif
\ No newline at end of file
@@ -131,6 +131,119 @@ void readEntry(FILE* fp, entry* e) {
     fseek(fp, MAX_SIZE_ENTRY - read_for_entry, SEEK_CUR);
 }
 
+/*
+ * readFieldFromBuffer does the same as readField, but reads the field at
+ * offset read_for_entry of record instead of from a file. If strings is not
+ * NULL, variable sized fields are stored at *strings (which is advanced past
+ * the stored string) instead of being allocated in the heap.
+ */
+static int32_t readFieldFromBuffer(
+    const char* record, field* f, int read_for_entry, char** strings) {
+    // an entry cannot be bigger than its max size
+    if (read_for_entry >= MAX_SIZE_ENTRY) {
+        return read_for_entry;
+    }
+
+    if (fields_size_arr[f->field_type] > 0) {
+        // fixed sized fields
+        memcpy(&(f->value), record + read_for_entry,
+            fields_size_arr[f->field_type]);
+        return fields_size_arr[f->field_type] + read_for_entry;
+    }
+
+    // variable sized fields end with '|' or at the end of the entry
+    const char* start = record + read_for_entry;
+    const char* end = memchr(start, '|', MAX_SIZE_ENTRY - read_for_entry);
+    int32_t len = end ? end - start : MAX_SIZE_ENTRY - read_for_entry;
+
+    char* str;
+    if (strings != NULL) {
+        str = *strings;
+        *strings += len + 1;
+    } else {
+        XALLOC(char, str, len + 1);
+    }
+    memcpy(str, start, len);
+    str[len] = '\0';
+    f->value.cpointer = str;
+
+    return read_for_entry + len + 1;
+}
+
+/*
+ * decodeEntry decodes the entry in record into e, storing variable sized
+ * fields as readFieldFromBuffer does.
+ */
+static void decodeEntry(const char* record, entry* e, char** strings) {
+    int32_t read_for_entry = readFieldFromBuffer(record, e->fields, 0, strings);
+    if (ENTRY_REMOVED(e)) {
+        // if the entry is deleted, only read the meta fields
+        readFieldFromBuffer(record, e->fields + 1, read_for_entry, strings);
+        return;
+    }
+
+    for (uint32_t i = 1; i < FIELD_AMOUNT; i++) {
+        read_for_entry = readFieldFromBuffer(
+            record, e->fields + i, read_for_entry, strings);
+    }
+}
+
+void readEntryFromBuffer(const char* record, entry* e) {
+    decodeEntry(record, e, NULL);
+}
+
+entryArena* createEntryArena(uint32_t capacity) {
+    entryArena* arena;
+    XALLOC(entryArena, arena, 1);
+
+    arena->entries = createEntry(capacity);
+    XALLOC(char, arena->records, (size_t)capacity * MAX_SIZE_ENTRY);
+    XALLOC(char, arena->strings, (size_t)capacity * ARENA_STRINGS_PER_ENTRY);
+    arena->capacity = capacity;
+    arena->size = 0;
+    arena->strings_end = arena->strings;
+
+    return arena;
+}
+
+void resetEntryArena(entryArena* arena) {
+    // strings belong to the arena, so just forget them instead of freeing
+    for (uint32_t i = 0; i < arena->size; i++) {
+        initEntry(arena->entries + i);
+    }
+
+    arena->size = 0;
+    arena->strings_end = arena->strings;
+}
+
+void deleteEntryArena(entryArena* arena) {
+    free(arena->entries);
+    free(arena->records);
+    free(arena->strings);
+    free(arena);
+}
+
+uint32_t readEntriesFromBuffer(
+    const char* records, entryArena* arena, uint32_t amount) {
+    amount = min(amount, arena->capacity - arena->size);
+
+    for (uint32_t i = 0; i < amount; i++) {
+        decodeEntry(records + (size_t)i * MAX_SIZE_ENTRY,
+            arena->entries + arena->size, &(arena->strings_end));
+        arena->size++;
+    }
+
+    return amount;
+}
+
+uint32_t readEntries(FILE* fp, entryArena* arena, uint32_t amount) {
+    amount = min(amount, arena->capacity - arena->size);
+
+    // a single read for the whole batch, then decode it from memory
+    amount = fread(arena->records, MAX_SIZE_ENTRY, amount, fp);
+    return readEntriesFromBuffer(arena->records, arena, amount);
+}
+
 int32_t writeField(FILE* fp, field* f, ssize_t size) {
     if (fields_size_arr[f->field_type] > 0) {
         // fixed sized fields
@@ -71,6 +71,30 @@ typedef struct {
     field fields[9];
 } entry;
 
+/*
+ * the most string bytes a single entry can take in an entryArena: both
+ * variable sized fields fit in the entry, plus their '\0's.
+ */
+#define ARENA_STRINGS_PER_ENTRY (MAX_SIZE_ENTRY + 2)
+
+/*
+ * struct entryArena owns a batch of up to capacity entries, of which the
+ * first size are in use. The variable sized fields of all entries are stored
+ * contiguously in strings (up to strings_end) instead of being allocated one
+ * by one, so the whole batch is freed or reset with a single call. records
+ * is a scratch buffer for the raw bytes of a batch.
+ *
+ * Entries of an arena must NOT be passed to deleteEntry or clearEntry.
+ */
+typedef struct {
+    entry* entries;
+    char* records;
+    char* strings;
+    char* strings_end;
+    uint32_t size;
+    uint32_t capacity;
+} entryArena;
+
 /*
  * createEntry creates a collection of entries, initializing all of them with
  * trash or NULL pointers in all fields.
@@ -105,6 +129,40 @@ int32_t readField(FILE* fp, field* f, int read_for_entry);
 // readEntry reads a full entry from fp.
 void readEntry(FILE* fp, entry* e);
 
+/*
+ * readEntryFromBuffer reads a full entry from record, a pointer to the
+ * MAX_SIZE_ENTRY bytes of an entry as they are stored in the binary file (for
+ * instance, a memory mapped table). It decodes the same way as readEntry.
+ */
+void readEntryFromBuffer(const char* record, entry* e);
+
+// createEntryArena creates an empty arena for up to capacity entries.
+entryArena* createEntryArena(uint32_t capacity);
+
+/*
+ * resetEntryArena empties the arena, invalidating all entries and strings
+ * previously read into it, so it can be reused for another batch.
+ */
+void resetEntryArena(entryArena* arena);
+
+// deleteEntryArena frees the arena and everything read into it.
+void deleteEntryArena(entryArena* arena);
+
+/*
+ * readEntriesFromBuffer decodes amount consecutive entries stored in records
+ * (in the same format as the binary file) and appends them to arena. It
+ * returns how many entries were decoded, which is less than amount if the
+ * arena fills up.
+ */
+uint32_t readEntriesFromBuffer(
+    const char* records, entryArena* arena, uint32_t amount);
+
+/*
+ * readEntries does the same as readEntriesFromBuffer, but reads the entries
+ * from fp with a single fread. Less than amount entries are read at EOF.
+ */
+uint32_t readEntries(FILE* fp, entryArena* arena, uint32_t amount);
+
 /*
  * WriteField writes a field f on the file fp if the contents
  * of the field are less than or equal to size. On success, it
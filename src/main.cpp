@@ -1,7 +1,14 @@
 #include <cerrno>
+#include <cstring>
 #include <iostream>
+#include <string>
+#include <unistd.h>
 
+#include "InputBuffer.hpp"
 #include "NetworkGraph.hpp"
+#include "QueryServer.hpp"
+#include "Stats.hpp"
+#include "Trace.hpp"
 #include "commands.hpp"
 #include "table.hpp"
 
@@ -9,42 +16,111 @@ extern "C" {
 #include "utils.h"
 }
 
-#define FIRST_COMMAND_NUM 11
-enum commands {
-    command_print = FIRST_COMMAND_NUM,
-    command_num_cicles,
-    command_max_speed,
-    command_length
-};
+/*
+ * the arguments that start the server mode, as in
+ * "main [--cache] [--stats] [--trace=file] --serve [--socket path] [table...]",
+ * see serve.
+ */
+#define SERVE_ARGUMENT "--serve"
+#define SOCKET_ARGUMENT "--socket"
 
-int main() {
+/*
+ * the argument that makes graphs be read from the graph file of their table
+ * (its name followed by GRAPH_FILE_EXTENSION) while it is fresh, and saved to
+ * it otherwise, see NetworkGraph::fromGraphFile.
+ */
+#define CACHE_ARGUMENT "--cache"
+
+/*
+ * the argument that does the same as CACHE_ARGUMENT, but also reads every
+ * graph file and its table in full to check the file, instead of trusting
+ * the table's size and modification time.
+ */
+#define VERIFY_CACHE_ARGUMENT "--verify-cache"
+
+/*
+ * serve runs the program as a QueryServer, with arguments being the ones
+ * after SERVE_ARGUMENT: the tables named in it are loaded upfront, and
+ * requests are answered from a Unix domain socket at the path after
+ * SOCKET_ARGUMENT, if there is one, or from the standard input otherwise.
+ * use_graph_files is whether CACHE_ARGUMENT (or VERIFY_CACHE_ARGUMENT) was
+ * given, and verify_graph_files whether VERIFY_CACHE_ARGUMENT was.
+ */
+static int serve(int num_arguments, char** arguments, bool use_graph_files,
+    bool verify_graph_files) {
+    QueryServer server(use_graph_files, verify_graph_files);
+    const char* socket_path = NULL;
+
+    for (int i = 0; i < num_arguments; i++) {
+        if (std::strcmp(arguments[i], SOCKET_ARGUMENT) == 0
+            && i + 1 < num_arguments) {
+            socket_path = arguments[++i];
+        } else if (!server.load(arguments[i])) {
+            errno = EINVAL;
+            ABORT_PROGRAM("table %s", arguments[i]);
+        }
+    }
+
+    if (socket_path == NULL) {
+        server.serveFile(STDIN_FILENO, std::cout);
+        return 0;
+    }
+
+    if (!server.serveSocket(socket_path)) {
+        ABORT_PROGRAM("socket %s", socket_path);
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Stats::enableFromEnvironment();
+    Trace::enableFromEnvironment();
+
+    // the options come first, in any order
+    bool use_graph_files = false;
+    bool verify_graph_files = false;
+    for (; argc > 1; argc--, argv++) {
+        if (std::strcmp(argv[1], CACHE_ARGUMENT) == 0) {
+            use_graph_files = true;
+        } else if (std::strcmp(argv[1], VERIFY_CACHE_ARGUMENT) == 0) {
+            use_graph_files = true;
+            verify_graph_files = true;
+        } else if (!Stats::enableFromArgument(argv[1])
+            && !Trace::enableFromArgument(argv[1])) {
+            break;
+        }
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], SERVE_ARGUMENT) == 0) {
+        return serve(
+            argc - 2, argv + 2, use_graph_files, verify_graph_files);
+    }
+
+    // the command's own input is read from the same buffer, see runCommand
+    InputBuffer input(STDIN_FILENO);
     int32_t command;
-    char* table_name;
-    READ_INPUT("%d %ms", &command, &table_name);
-
-    Table* topology = new Table(table_name, "rb");
-    NetworkGraph* net_topology = new NetworkGraph(*topology);
-
-    switch (command) {
-    case command_print:
-        std::cout << *net_topology;
-        break;
-    case command_num_cicles:
-        std::cout << "Quantidade de ciclos: " << net_topology->getNumCicles();
-        std::cout << std::endl;
-        break;
-    case command_max_speed:
-        commandMaxSpeed(*net_topology);
-        break;
-    case command_length:
-        commandLength(*net_topology);
-        break;
-    default:
+    std::string table_name;
+    if (!input.read(command) || !input.read(table_name)) {
+        ABORT_PROGRAM("Invalid input format");
+    }
+
+    Table* topology = new Table(table_name.data(), "rb");
+    NetworkGraph* net_topology;
+    if (use_graph_files) {
+        std::string graph_file_name
+            = table_name + GRAPH_FILE_EXTENSION;
+        net_topology = NetworkGraph::fromGraphFile(
+            *topology, graph_file_name.c_str(), verify_graph_files);
+    } else {
+        net_topology = new NetworkGraph(*topology);
+    }
+
+    if (!runCommand(command, *net_topology, input, std::cout)) {
         errno = EINVAL;
         ABORT_PROGRAM("command number");
     }
 
     delete net_topology;
     delete topology;
-    free(table_name);
 }
@@ -1,3 +1,85 @@
 build/obj/table.o: src/Graph.hxx
 build/obj/main.o: src/Graph.hxx
 build/obj/NetworkGraph.o: src/Graph.hxx
+build/obj/table.o: src/EntryView.hpp
+build/obj/main.o: src/EntryView.hpp
+build/obj/NetworkGraph.o: src/EntryView.hpp
+build/obj/commands.o: src/EntryView.hpp
+build/obj/table.o: src/NodeMarks.hpp src/ShortestPaths.hpp src/ShortestPaths.hxx
+build/obj/main.o: src/NodeMarks.hpp src/ShortestPaths.hpp src/ShortestPaths.hxx
+build/obj/NetworkGraph.o: src/NodeMarks.hpp src/ShortestPaths.hpp src/ShortestPaths.hxx
+build/obj/Graph.o: src/NodeMarks.hpp src/ShortestPaths.hpp
+build/obj/commands.o: src/NodeMarks.hpp src/ShortestPaths.hpp src/ShortestPaths.hxx
+build/obj/table.o: src/MaxFlow.hpp src/MaxFlow.hxx
+build/obj/main.o: src/MaxFlow.hpp src/MaxFlow.hxx
+build/obj/NetworkGraph.o: src/MaxFlow.hpp src/MaxFlow.hxx
+build/obj/commands.o: src/MaxFlow.hpp src/MaxFlow.hxx
+build/obj/table.o: src/FlowTree.hpp
+build/obj/main.o: src/FlowTree.hpp
+build/obj/NetworkGraph.o: src/FlowTree.hpp
+build/obj/commands.o: src/FlowTree.hpp
+build/obj/table.o: src/UnionFind.hpp
+build/obj/main.o: src/UnionFind.hpp
+build/obj/NetworkGraph.o: src/UnionFind.hpp
+build/obj/commands.o: src/UnionFind.hpp
+build/obj/table.o: src/CicleTasks.hpp
+build/obj/main.o: src/CicleTasks.hpp
+build/obj/NetworkGraph.o: src/CicleTasks.hpp
+build/obj/Graph.o: src/CicleTasks.hpp
+build/obj/commands.o: src/CicleTasks.hpp
+build/obj/Graph.o: src/UnionFind.hpp
+build/obj/main.o: src/QueryServer.hpp
+build/obj/QueryServer.o: src/Graph.hxx src/EntryView.hpp src/NodeMarks.hpp src/ShortestPaths.hpp src/ShortestPaths.hxx
+build/obj/QueryServer.o: src/MaxFlow.hpp src/MaxFlow.hxx src/FlowTree.hpp src/UnionFind.hpp src/CicleTasks.hpp
+build/obj/commands.o: src/ParallelFor.hpp src/ParallelFor.hxx
+build/obj/NetworkSnapshot.o: src/NetworkGraph.hpp src/Graph.hpp src/Graph.hxx src/EntryView.hpp src/table.hpp
+build/obj/NetworkSnapshot.o: src/NodeMarks.hpp src/ShortestPaths.hpp src/ShortestPaths.hxx src/MaxFlow.hpp src/MaxFlow.hxx
+build/obj/NetworkSnapshot.o: src/FlowTree.hpp src/UnionFind.hpp src/CicleTasks.hpp
+build/obj/GraphFile.o: src/table.hpp src/Graph.hpp src/Graph.hxx src/EntryView.hpp src/NodeMarks.hpp
+build/obj/GraphFile.o: src/ShortestPaths.hpp src/ShortestPaths.hxx src/UnionFind.hpp src/CicleTasks.hpp
+build/obj/main.o: src/GraphFile.hpp
+build/obj/NetworkGraph.o: src/GraphFile.hpp
+build/obj/commands.o: src/GraphFile.hpp
+build/obj/QueryServer.o: src/GraphFile.hpp
+build/obj/NetworkSnapshot.o: src/GraphFile.hpp
+build/obj/main.o: src/OutputBuffer.hpp
+build/obj/NetworkGraph.o: src/OutputBuffer.hpp
+build/obj/commands.o: src/OutputBuffer.hpp
+build/obj/QueryServer.o: src/OutputBuffer.hpp
+build/obj/NetworkSnapshot.o: src/OutputBuffer.hpp
+build/obj/main.o: src/InputBuffer.hpp
+build/obj/commands.o: src/InputBuffer.hpp
+build/obj/QueryServer.o: src/InputBuffer.hpp
+build/obj/main.o: src/Stats.hpp
+build/obj/table.o: src/Stats.hpp
+build/obj/NetworkGraph.o: src/Stats.hpp
+build/obj/Graph.o: src/Stats.hpp
+build/obj/commands.o: src/Stats.hpp
+build/obj/QueryServer.o: src/Stats.hpp
+build/obj/NetworkSnapshot.o: src/Stats.hpp
+build/obj/GraphFile.o: src/Stats.hpp
+build/obj/main.o: src/Trace.hpp
+build/obj/table.o: src/Trace.hpp
+build/obj/NetworkGraph.o: src/Trace.hpp
+build/obj/Graph.o: src/Trace.hpp
+build/obj/commands.o: src/Trace.hpp
+build/obj/QueryServer.o: src/Trace.hpp
+build/obj/NetworkSnapshot.o: src/Trace.hpp
+build/obj/GraphFile.o: src/Trace.hpp
+build/obj/main.o: src/NetworkGraph.hpp src/commands.hpp
+build/obj/table.o: src/NetworkGraph.hpp
+build/obj/commands.o: src/NetworkGraph.hpp
+build/obj/QueryServer.o: src/NetworkGraph.hpp src/commands.hpp
+build/obj/table.o: src/CSRArray.hpp src/CSRArray.hxx
+build/obj/main.o: src/CSRArray.hpp src/CSRArray.hxx
+build/obj/NetworkGraph.o: src/CSRArray.hpp src/CSRArray.hxx
+build/obj/Graph.o: src/CSRArray.hpp
+build/obj/commands.o: src/CSRArray.hpp src/CSRArray.hxx
+build/obj/QueryServer.o: src/CSRArray.hpp src/CSRArray.hxx
+build/obj/NetworkSnapshot.o: src/CSRArray.hpp src/CSRArray.hxx
+build/obj/GraphFile.o: src/CSRArray.hpp src/CSRArray.hxx
+build/obj/MaxFlow.o: src/CSRArray.hpp src/CSRArray.hxx
+build/obj/ShortestPaths.o: src/CSRArray.hpp
+build/obj/main.o: src/NetworkSnapshot.hpp
+build/obj/commands.o: src/NetworkSnapshot.hpp
+build/obj/QueryServer.o: src/NetworkSnapshot.hpp
@@ -1,10 +1,18 @@
+#include <algorithm>
 #include <cerrno>
 #include <cstdio>
 #include <cstring>
 #include <system_error>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "Graph.hpp"
 #include "NetworkGraph.hpp"
+#include "Stats.hpp"
+#include "Trace.hpp"
 #include "table.hpp"
 
 extern "C" {
@@ -46,10 +54,52 @@ void Table::writeHeader() const {
     }
 }
 
+void Table::mapTable() {
+    struct stat file_stat;
+    if (fstat(fileno(fp), &file_stat) != 0
+        || file_stat.st_size <= PAGE_SIZE) {
+        return; // nothing to map, the stdio path handles empty tables.
+    }
+
+    void* addr = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE,
+        fileno(fp), 0);
+    if (addr == MAP_FAILED) {
+        return;
+    }
+
+    // entries are almost always read in order, so let the kernel read ahead
+    madvise(addr, file_stat.st_size, MADV_SEQUENTIAL);
+
+    mapping = (const char*)addr;
+    mapping_size = file_stat.st_size;
+}
+
+size_t Table::mappedEntries() const {
+    return std::min(
+        (size_t)metadata->nextRRN, (mapping_size - PAGE_SIZE) / MAX_SIZE_ENTRY);
+}
+
 Table::Table(char* table_name, const char* mode) {
+    StatTimer timer(stat_table_open);
+    TraceScope trace("table_open");
+    mapping = NULL;
+    mapping_size = 0;
+    cursor = 0;
+
     XALLOC(header, metadata, 1);
     OPEN_FILE(fp, table_name, mode);
-    readHeader();
+
+    if (std::strchr(mode, 'w') != NULL) {
+        // the file was just truncated, so the table starts empty
+        metadata->status = OK_HEADER;
+        metadata->stack = EMPTY_STACK;
+        metadata->nextRRN = 0;
+        metadata->entries_removed = 0;
+        metadata->pages = NUM_PAGES_FORMULA(0);
+        metadata->times_compacted = 0;
+    } else {
+        readHeader();
+    }
 
     if (metadata->status == ERR_HEADER) {
         // if the header is not OK, the whole file is invalid and an error is
@@ -60,26 +110,33 @@ Table::Table(char* table_name, const char* mode) {
     if (std::strchr(mode, 'w') != NULL || std::strchr(mode, '+') != NULL) {
         // if we are opening the file for writing, write that the file is
         // invalid (the status will be restored at closeTable)
+        read_only = false;
         metadata->status = ERR_HEADER;
         writeHeader();
-        read_only = false;
     } else {
         read_only = true;
+        mapTable();
     }
 }
 
 void Table::seek(size_t entry_number) const {
     IS_TABLE_OPENED(this, "couldn't seek entry on table");
+    cursor = entry_number;
     std::fseek(fp, entry_number * MAX_SIZE_ENTRY + PAGE_SIZE, SEEK_SET);
 }
 
 void Table::rewind() const {
     IS_TABLE_OPENED(this, "couldn't rewind table");
+    cursor = 0;
     std::fseek(fp, PAGE_SIZE, SEEK_SET);
 }
 
 bool Table::hasNextEntry() const {
     IS_TABLE_OPENED(this, "couldn't check if there is a next entry");
+    if (mapping != NULL) {
+        return cursor < mappedEntries();
+    }
+
     int c;
     if ((c = std::getc(fp)) == EOF) {
         return false;
@@ -96,10 +153,87 @@ entry* Table::readNextEntry() const {
     }
 
     entry* new_entry = createEntry(1);
+    if (mapping != NULL) {
+        // decode straight from the mapping, no stdio calls involved
+        readEntryFromBuffer(
+            mapping + PAGE_SIZE + cursor * MAX_SIZE_ENTRY, new_entry);
+        cursor++;
+        return new_entry;
+    }
+
     readEntry(fp, new_entry);
     return new_entry;
 }
 
+bool Table::readNextEntryView(EntryView& view) const {
+    IS_TABLE_OPENED(this, "couldn't read next entry");
+    if (mapping != NULL) {
+        if (cursor >= mappedEntries()) {
+            return false;
+        }
+
+        view = EntryView(mapping + PAGE_SIZE + cursor * MAX_SIZE_ENTRY);
+        cursor++;
+        return true;
+    }
+
+    // read the whole entry at once and decode it from the buffer
+    if (std::fread(record_buffer, MAX_SIZE_ENTRY, 1, fp) != 1) {
+        return false;
+    }
+
+    cursor++;
+    view = EntryView(record_buffer);
+    return true;
+}
+
+uint32_t Table::readEntries(entryArena* arena, uint32_t amount) const {
+    IS_TABLE_OPENED(this, "couldn't read entries");
+    if (mapping == NULL) {
+        amount = ::readEntries(fp, arena, amount);
+        cursor += amount;
+        return amount;
+    }
+
+    // the batch is already in memory, so decode it in place
+    size_t remaining = cursor < mappedEntries() ? mappedEntries() - cursor : 0;
+    amount = std::min((size_t)amount, remaining);
+    amount = readEntriesFromBuffer(
+        mapping + PAGE_SIZE + cursor * MAX_SIZE_ENTRY, arena, amount);
+    cursor += amount;
+    return amount;
+}
+
+size_t Table::entryCount() const {
+    IS_TABLE_OPENED(this, "couldn't count entries");
+    if (mapping != NULL) {
+        return mappedEntries();
+    }
+
+    return metadata->nextRRN;
+}
+
+bool Table::viewEntry(size_t rrn, EntryView& view, char* buffer) const {
+    if (mapping != NULL) {
+        if (rrn >= mappedEntries()) {
+            return false;
+        }
+
+        view = EntryView(mapping + PAGE_SIZE + rrn * MAX_SIZE_ENTRY);
+        return true;
+    }
+
+    // pread does not share the file offset, so it is safe between threads
+    ssize_t read_bytes = pread(fileno(fp), buffer, MAX_SIZE_ENTRY,
+        PAGE_SIZE + rrn * MAX_SIZE_ENTRY);
+    if (read_bytes != MAX_SIZE_ENTRY) {
+        return false;
+    }
+
+    view = EntryView(buffer);
+    return true;
+}
+
 int32_t Table::appendEntry(entry* es) {
     IS_TABLE_OPENED(this, "couldn't append entry");
     if (read_only) {
@@ -157,6 +291,84 @@ void Table::writeEmptyEntry() const {
     }
 }
 
+bool Table::isMapped() const { return mapping != NULL; }
+
+uint64_t Table::contentHash() const {
+    IS_TABLE_OPENED(this, "couldn't hash table");
+
+    // FNV-1a over the header fields
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const void* data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ ((const uint8_t*)data)[i]) * 1099511628211ull;
+        }
+    };
+
+    add(&metadata->stack, sizeof(int32_t));
+    add(&metadata->nextRRN, sizeof(uint32_t));
+    add(&metadata->entries_removed, sizeof(uint32_t));
+    add(&metadata->times_compacted, sizeof(uint32_t));
+
+    /*
+     * the same over every record, but a word at a time, so that hashing the
+     * whole table costs little more than reading it
+     */
+    auto add_words = [&hash](const char* data, size_t size) {
+        for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(uint64_t));
+            hash = (hash ^ word) * 1099511628211ull;
+            hash ^= hash >> 29;
+        }
+    };
+
+    size_t entries = entryCount();
+    if (mapping != NULL) {
+        add_words(mapping + PAGE_SIZE, entries * MAX_SIZE_ENTRY);
+        return hash;
+    }
+
+    std::vector<char> buffer(CONTENT_HASH_BLOCK_ENTRIES * MAX_SIZE_ENTRY);
+    for (size_t rrn = 0; rrn < entries; rrn += CONTENT_HASH_BLOCK_ENTRIES) {
+        size_t block = std::min<size_t>(
+            CONTENT_HASH_BLOCK_ENTRIES, entries - rrn);
+        ssize_t read = pread(fileno(fp), buffer.data(),
+            block * MAX_SIZE_ENTRY, PAGE_SIZE + rrn * MAX_SIZE_ENTRY);
+        if (read <= 0) {
+            break;
+        }
+
+        // a partially read record is left out, like the missing ones
+        add_words(buffer.data(), read - read % MAX_SIZE_ENTRY);
+    }
+
+    return hash;
+}
+
+uint32_t Table::getNextRRN() const {
+    IS_TABLE_OPENED(this, "couldn't retrieve next RRN");
+    return metadata->nextRRN;
+}
+
+bool Table::getFileStat(uint64_t& size, int64_t& modification_time) const {
+    IS_TABLE_OPENED(this, "couldn't stat table");
+
+    struct stat file_stat;
+    if (fstat(fileno(fp), &file_stat) != 0) {
+        return false;
+    }
+
+    size = file_stat.st_size;
+    modification_time = (int64_t)file_stat.st_mtim.tv_sec * 1000000000
+        + file_stat.st_mtim.tv_nsec;
+    return true;
+}
+
+uint32_t Table::getEntriesRemoved() const {
+    IS_TABLE_OPENED(this, "couldn't retrieve entries removed");
+    return metadata->entries_removed;
+}
+
 uint32_t Table::getTimesCompacted() const {
     IS_TABLE_OPENED(this, "couldn't retrieve times compacted");
     return metadata->times_compacted;
@@ -177,6 +389,10 @@ Table::~Table() {
         writeHeader();
     }
 
+    if (mapping != NULL) {
+        munmap((void*)mapping, mapping_size);
+    }
+
     std::fclose(fp);
     std::free(metadata);
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <stdexcept>
 #include <string>
 
+#include "EntryView.hpp"
 #include "Graph.hxx"
 
 extern "C" {
@@ -21,6 +22,12 @@ extern "C" {
 #define ERR_HEADER '0'
 #define EMPTY_STACK -1
 
+/*
+ * the number of records contentHash reads at a time from tables that are not
+ * memory mapped.
+ */
+#define CONTENT_HASH_BLOCK_ENTRIES 1024
+
 /* The number of disk pages occupied by a table is the ceiling
  * of table_size/PAGE_SIZE. Its gruesome formula (that maximizes
  * efficiency) is given by the expression below:
@@ -55,6 +62,34 @@ private:
     FILE* fp;
     bool read_only;
 
+    /*
+     * read-only tables are memory mapped: mapping points to the whole file
+     * (header page included), mapping_size is its size in bytes and cursor is
+     * the RRN of the next entry to be read. If the file could not be mapped,
+     * mapping is NULL and all reads fall back to fp.
+     */
+    const char* mapping;
+    size_t mapping_size;
+    mutable size_t cursor;
+
+    /*
+     * record_buffer holds the last entry read through readNextEntryView when
+     * the table is not memory mapped.
+     */
+    mutable char record_buffer[MAX_SIZE_ENTRY];
+
+    /*
+     * mapTable maps the table file in memory for reading. On failure, the
+     * table is left unmapped.
+     */
+    void mapTable();
+
+    /*
+     * mappedEntries returns how many entries can be read from the mapping,
+     * bounded both by the nextRRN in the header and the size of the file.
+     */
+    size_t mappedEntries() const;
+
     /*
      * readheader reads the header from the table binary file.
      */
@@ -95,6 +130,38 @@ public:
      */
     entry* readNextEntry() const;
 
+    /*
+     * readNextEntryView reads the next entry from the table into view without
+     * allocating any memory, returning false if there are no entries left.
+     * The view points either to the memory mapped file or to an internal
+     * buffer, so it is only valid until the next read or the table is closed.
+     */
+    bool readNextEntryView(EntryView& view) const;
+
+    /*
+     * readEntries decodes up to amount consecutive entries, starting at the
+     * next one, into arena, returning how many were read. Reading stops early
+     * at the end of the table or if the arena is full. All strings of the
+     * batch are owned by the arena, see entryArena.
+     */
+    uint32_t readEntries(entryArena* arena, uint32_t amount) const;
+
+    /*
+     * entryCount returns the number of entries (removed ones included) in the
+     * table, i.e., the RRNs that can be read are [0, entryCount()).
+     */
+    size_t entryCount() const;
+
+    /*
+     * viewEntry views the entry of number rrn, returning false if it could not
+     * be read. It does not use or move the table's read position, so it can be
+     * called concurrently from multiple threads: mapped tables are viewed in
+     * place, others are read with pread into buffer, which must hold
+     * MAX_SIZE_ENTRY bytes and outlive the view. Writes still buffered by
+     * the table are not seen by unmapped reads.
+     */
+    bool viewEntry(size_t rrn, EntryView& view, char* buffer) const;
+
     /*
      * appendEntry writes entry es on the table. If the stack of
      * deleted entries is empty, it appends the entry at the end of the table.
@@ -108,6 +175,27 @@ public:
      */
     void removeEntry(size_t rrn);
 
+    /*
+     * contentHash returns a hash of the table's header and of every record
+     * in it, removed ones included, so any change to the table changes the
+     * hash (up to collisions). It reads the whole table, which for mapped
+     * tables costs about as much as one scan of the file.
+     */
+    uint64_t contentHash() const;
+
+    /*
+     * getFileStat sets size to the size of the table's file in bytes and
+     * modification_time to the time it was last modified, in nanoseconds
+     * since the epoch, returning false if they could not be read. Writes
+     * still buffered by the table are not seen.
+     */
+    bool getFileStat(uint64_t& size, int64_t& modification_time) const;
+
+    uint32_t getNextRRN() const; // getNextRRN returns the header's nextRRN.
+
+    // getEntriesRemoved returns the number of removed entries in the header.
+    uint32_t getEntriesRemoved() const;
+
     /*
      * getTimesCompacted returns the number of times the table has been
      * compacted.
@@ -121,12 +209,19 @@ public:
      */
     void setTimesCompacted(uint32_t num_times_compacted);
 
+    /*
+     * isMapped returns whether the entries are read directly from a memory
+     * mapping of the file (the default for read-only tables) instead of stdio.
+     */
+    bool isMapped() const;
+
     /*
      * creates a new table using the file named table_name with a
      * mode specified by the user. It supports "rb", read-only mode,
      * "r+b", read and write mode, and "wb", write-only mode. These
      * modes work in the same way as file descriptors in the C
-     * standart library.
+     * standart library. Read-only tables are memory mapped, and write-only
+     * tables start empty, with a new header.
      */
     Table(char* table_name, const char* mode);
 